@@ -0,0 +1,324 @@
+/*
+ * File:        capture.c
+ * Description: GPIO capture (logic analyzer) implementation.
+ * Programmer:  tnewman
+ * Date:        Oct 16, 2026
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 Thomas Newman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#define _GNU_SOURCE
+
+#include "capture.h"
+#include "internal.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*
+ * Configuration
+ */
+#define CACHE_LINE_SIZE 64
+#define NANOSECONDS_PER_SECOND 1000000000ULL
+
+/*
+ * Name: CaptureEngine
+ * Description: The ring indexes only ever increase and are masked when used. The producer and consumer indexes live 
+ *              on separate cache lines, and each side keeps a cached copy of the other side's index so it only 
+ *              touches the shared line when its cached copy runs out.
+ */
+struct CaptureEngine {
+    // Shared configuration
+    CaptureSample* ring;
+    size_t ring_mask;
+    PinMask pin_mask;
+    pthread_t sampler_thread;
+    atomic_bool running;
+
+    // Producer (sampler thread)
+    _Alignas(CACHE_LINE_SIZE) atomic_size_t head;
+    size_t cached_tail;
+    atomic_uint_fast64_t samples_taken;
+    atomic_uint_fast64_t changes_recorded;
+    atomic_uint_fast64_t changes_dropped;
+
+    // Consumer
+    _Alignas(CACHE_LINE_SIZE) atomic_size_t tail;
+    size_t cached_head;
+};
+
+/*
+ * Implementation Functions
+ *
+ * These functions are for internal use only.
+ */
+
+/*
+ * Name: run_sampler
+ * Description: Body of the sampler thread.
+ * Parameters:
+ *       argument[in] - The capture engine.
+ * Returns: Always 0x00.
+ */
+static void* run_sampler(void* argument);
+
+/*
+ * Name: push_sample
+ * Description: Pushes a sample into the ring, or counts it as dropped if the ring is full.
+ * Parameters:
+ *       capture_engine[in] - The capture engine.
+ *       levels[in] - Levels of the captured pins.
+ * Returns: None
+ */
+static void push_sample(CaptureEngine* capture_engine, PinMask levels);
+
+StatusCode start_gpio_capture(PinMask pin_mask, size_t ring_size, int cpu, CaptureEngine** capture_engine)
+{
+    CaptureEngine* engine;
+    size_t capacity = 1;
+    cpu_set_t cpu_set;
+    pthread_attr_t thread_attributes;
+    int result;
+
+    // Check initialization
+    if(!check_init())
+    {
+        return NO_INIT;
+    }
+
+    if(pin_mask == 0x00 || (pin_mask >> (GPIO_PIN_COUNT + 1)) != 0)
+    {
+        return INVALID_PIN;
+    }
+
+    // Rounding up must not run past the largest power of two, and the ring must fit in memory
+    if(ring_size > SIZE_MAX / 2 + 1 || cpu >= CPU_SETSIZE)
+    {
+        return UNSUPPORTED;
+    }
+
+    while(capacity < ring_size)
+    {
+        capacity <<= 1;
+    }
+
+    if(capacity > SIZE_MAX / sizeof(CaptureSample))
+    {
+        return UNSUPPORTED;
+    }
+
+    engine = aligned_alloc(CACHE_LINE_SIZE, (sizeof(CaptureEngine) + CACHE_LINE_SIZE - 1) & ~(CACHE_LINE_SIZE - 1));
+
+    if(engine == 0x00)
+    {
+        return REGISTER_FAILURE;
+    }
+
+    engine->ring = malloc(capacity * sizeof(CaptureSample));
+
+    if(engine->ring == 0x00)
+    {
+        free(engine);
+        return REGISTER_FAILURE;
+    }
+
+    engine->ring_mask = capacity - 1;
+    engine->pin_mask = pin_mask;
+    atomic_init(&engine->running, true);
+    atomic_init(&engine->head, 0);
+    atomic_init(&engine->tail, 0);
+    atomic_init(&engine->samples_taken, 0);
+    atomic_init(&engine->changes_recorded, 0);
+    atomic_init(&engine->changes_dropped, 0);
+    engine->cached_tail = 0;
+    engine->cached_head = 0;
+
+    // The sampler thread is placed on its CPU before it runs, so no samples are taken on the wrong core
+    if(pthread_attr_init(&thread_attributes) != 0)
+    {
+        free(engine->ring);
+        free(engine);
+        return REGISTER_FAILURE;
+    }
+
+    result = 0;
+
+    if(cpu >= 0)
+    {
+        CPU_ZERO(&cpu_set);
+        CPU_SET(cpu, &cpu_set);
+        result = pthread_attr_setaffinity_np(&thread_attributes, sizeof(cpu_set), &cpu_set);
+    }
+
+    if(result == 0)
+    {
+        result = pthread_create(&engine->sampler_thread, &thread_attributes, run_sampler, engine);
+    }
+
+    pthread_attr_destroy(&thread_attributes);
+
+    if(result != 0)
+    {
+        free(engine->ring);
+        free(engine);
+        return REGISTER_FAILURE;
+    }
+
+    *capture_engine = engine;
+
+    return SUCCESS;
+}
+
+size_t read_gpio_capture(CaptureEngine* capture_engine, CaptureSample* samples, size_t sample_count)
+{
+    size_t tail = atomic_load_explicit(&capture_engine->tail, memory_order_relaxed);
+    size_t available;
+    size_t i;
+
+    // Only look at the producer's index once the cached copy has been used up
+    if(capture_engine->cached_head == tail)
+    {
+        capture_engine->cached_head = atomic_load_explicit(&capture_engine->head, memory_order_acquire);
+    }
+
+    available = capture_engine->cached_head - tail;
+
+    if(sample_count > available)
+    {
+        sample_count = available;
+    }
+
+    for(i = 0; i < sample_count; i++)
+    {
+        samples[i] = capture_engine->ring[(tail + i) & capture_engine->ring_mask];
+    }
+
+    // Hand the slots back to the producer in one store
+    atomic_store_explicit(&capture_engine->tail, tail + sample_count, memory_order_release);
+
+    return sample_count;
+}
+
+void get_gpio_capture_statistics(CaptureEngine* capture_engine, CaptureStatistics* capture_statistics)
+{
+    capture_statistics->samples_taken = atomic_load_explicit(&capture_engine->samples_taken, memory_order_relaxed);
+    capture_statistics->changes_recorded = atomic_load_explicit(&capture_engine->changes_recorded, 
+            memory_order_relaxed);
+    capture_statistics->changes_dropped = atomic_load_explicit(&capture_engine->changes_dropped, memory_order_relaxed);
+}
+
+void stop_gpio_capture(CaptureEngine* capture_engine)
+{
+    atomic_store_explicit(&capture_engine->running, false, memory_order_relaxed);
+    pthread_join(capture_engine->sampler_thread, 0x00);
+
+    free(capture_engine->ring);
+    free(capture_engine);
+}
+
+static void* run_sampler(void* argument)
+{
+    CaptureEngine* engine = argument;
+    volatile Register_Type* level_register = gpio_memory + calculate_offset(GPLEV0);
+    PinMask pin_mask = engine->pin_mask;
+    PinMask previous_levels;
+    PinMask levels;
+    uint64_t samples_taken = 0;
+    unsigned int interval = 0;
+    bool both_banks = (pin_mask >> REGISTER_SIZE) != 0;
+
+    previous_levels = read_register_pair(GPLEV0) & pin_mask;
+    push_sample(engine, previous_levels);
+
+    while(true)
+    {
+        // Only read the second bank when it holds captured pins
+        levels = level_register[0];
+
+        if(both_banks)
+        {
+            levels |= (PinMask) level_register[1] << REGISTER_SIZE;
+        }
+
+        levels &= pin_mask;
+        samples_taken++;
+
+        if(levels != previous_levels)
+        {
+            push_sample(engine, levels);
+            previous_levels = levels;
+        }
+
+        // Publish the sample count and check for a stop request now and then, not on every sample
+        if(++interval == CAPTURE_PUBLISH_INTERVAL)
+        {
+            interval = 0;
+            atomic_store_explicit(&engine->samples_taken, samples_taken, memory_order_relaxed);
+
+            if(!atomic_load_explicit(&engine->running, memory_order_relaxed))
+            {
+                break;
+            }
+        }
+    }
+
+    return 0x00;
+}
+
+static void push_sample(CaptureEngine* capture_engine, PinMask levels)
+{
+    size_t head = atomic_load_explicit(&capture_engine->head, memory_order_relaxed);
+    CaptureSample* sample;
+    struct timespec time;
+
+    // Only look at the consumer's index once the ring looks full
+    if(head - capture_engine->cached_tail > capture_engine->ring_mask)
+    {
+        capture_engine->cached_tail = atomic_load_explicit(&capture_engine->tail, memory_order_acquire);
+
+        if(head - capture_engine->cached_tail > capture_engine->ring_mask)
+        {
+            atomic_store_explicit(&capture_engine->changes_dropped, 
+                    atomic_load_explicit(&capture_engine->changes_dropped, memory_order_relaxed) + 1, 
+                    memory_order_relaxed);
+            return;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    sample = &capture_engine->ring[head & capture_engine->ring_mask];
+    sample->timestamp = time.tv_sec * NANOSECONDS_PER_SECOND + time.tv_nsec;
+    sample->levels = levels;
+
+    atomic_store_explicit(&capture_engine->head, head + 1, memory_order_release);
+    atomic_store_explicit(&capture_engine->changes_recorded, 
+            atomic_load_explicit(&capture_engine->changes_recorded, memory_order_relaxed) + 1, memory_order_relaxed);
+}
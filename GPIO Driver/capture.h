@@ -0,0 +1,118 @@
+/*
+ * File:        capture.h
+ * Description: Definition of the GPIO capture (logic analyzer) functions and data types.
+ * Programmer:  tnewman
+ * Date:        Oct 16, 2026
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 Thomas Newman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include "gpio.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Configuration
+ */
+#define CAPTURE_PUBLISH_INTERVAL 256
+
+/*
+ * Name: CaptureSample
+ * Description: The levels of the captured pins right after they changed.
+ */
+typedef struct {
+    uint64_t timestamp; // Monotonic clock time of the sample in nanoseconds.
+    PinMask levels; // Levels of the captured pins (Broadcom numbering).
+} CaptureSample;
+
+/*
+ * Name: CaptureStatistics
+ * Description: Counters kept by the sampler thread of a capture.
+ */
+typedef struct {
+    uint64_t samples_taken; // Number of times the level registers were read.
+    uint64_t changes_recorded; // Number of changes pushed into the ring.
+    uint64_t changes_dropped; // Number of changes lost because the ring was full.
+} CaptureStatistics;
+
+/*
+ * Name: CaptureEngine
+ * Description: A running capture. The sampler thread reads the level registers as fast as it can and pushes a 
+ *              timestamped sample into a single-producer, single-consumer lock-free ring whenever the captured pins 
+ *              change. One consumer thread drains the ring with read_gpio_capture.
+ */
+typedef struct CaptureEngine CaptureEngine;
+
+/*
+ * Name: start_gpio_capture
+ * Description: Starts a sampler thread that captures changes on a set of pins. The first sample holds the levels 
+ *              when the capture started.
+ * Note: Must be called after initialize_gpio. The sampler thread keeps one core busy until stop_gpio_capture.
+ * Parameters:
+ *       pin_mask[in] - The pins to capture (Broadcom numbering).
+ *       ring_size[in] - Number of samples the ring can hold. Rounded up to a power of two (UNSUPPORTED when that 
+ *                       does not fit in memory).
+ *       cpu[in] - The CPU to run the sampler thread on, or a negative number to let the scheduler choose.
+ *       capture_engine[out] - The running capture.
+ * Returns: Result of the operation.
+ */
+StatusCode start_gpio_capture(PinMask pin_mask, size_t ring_size, int cpu, CaptureEngine** capture_engine);
+
+/*
+ * Name: read_gpio_capture
+ * Description: Moves the oldest samples out of the ring without waiting for new ones.
+ * Note: Only one thread may read from a capture.
+ * Parameters:
+ *       capture_engine[in] - The running capture.
+ *       samples[out] - Buffer receiving the samples, oldest first.
+ *       sample_count[in] - Number of samples the buffer can hold.
+ * Returns: Number of samples moved into the buffer.
+ */
+size_t read_gpio_capture(CaptureEngine* capture_engine, CaptureSample* samples, size_t sample_count);
+
+/*
+ * Name: get_gpio_capture_statistics
+ * Description: Gets the counters of a capture. samples_taken is published every CAPTURE_PUBLISH_INTERVAL samples.
+ * Parameters:
+ *       capture_engine[in] - The running capture.
+ *       capture_statistics[out] - The counters of the capture.
+ * Returns: None
+ */
+void get_gpio_capture_statistics(CaptureEngine* capture_engine, CaptureStatistics* capture_statistics);
+
+/*
+ * Name: stop_gpio_capture
+ * Description: Stops the sampler thread and frees the capture. Samples still in the ring are discarded.
+ * Parameters:
+ *       capture_engine[in] - The running capture.
+ * Returns: None
+ */
+void stop_gpio_capture(CaptureEngine* capture_engine);
+
+#endif /* CAPTURE_H_ */
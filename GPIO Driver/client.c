@@ -0,0 +1,232 @@
+/*
+ * File:        client.c
+ * Description: GPIO daemon client implementation.
+ * Programmer:  tnewman
+ * Date:        Oct 16, 2026
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 Thomas Newman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "client.h"
+
+#include <poll.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/*
+ * Name: DaemonClient
+ * Description: The socket, the mapped ring, and the eventfd used to wake the daemon.
+ */
+struct DaemonClient {
+    int socket_file;
+    int wake_file;
+    DaemonRing* ring;
+};
+
+/*
+ * Implementation Functions
+ *
+ * These functions are for internal use only.
+ */
+
+/*
+ * Name: receive_files
+ * Description: Receives the ring and eventfd file descriptors sent by the daemon.
+ * Parameters:
+ *       socket_file[in] - The connected socket.
+ *       ring_file[out] - The shared memory file of the ring.
+ *       wake_file[out] - The eventfd used to wake the daemon.
+ * Returns: true if both files were received, otherwise false.
+ */
+static bool receive_files(int socket_file, int* ring_file, int* wake_file);
+
+StatusCode connect_gpio_daemon(const char* socket_path, DaemonClient** daemon_client)
+{
+    DaemonClient* client;
+    struct sockaddr_un address;
+    int ring_file;
+
+    client = malloc(sizeof(DaemonClient));
+
+    if(client == 0x00)
+    {
+        return CANNOT_MAP_MEMORY;
+    }
+
+    memset(&address, 0x00, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, socket_path ? socket_path : DAEMON_SOCKET_PATH, sizeof(address.sun_path) - 1);
+
+    client->socket_file = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+    if(client->socket_file < 0)
+    {
+        free(client);
+        return CANNOT_MAP_MEMORY;
+    }
+
+    if(connect(client->socket_file, (struct sockaddr*) &address, sizeof(address)) != 0 || 
+       !receive_files(client->socket_file, &ring_file, &client->wake_file))
+    {
+        close(client->socket_file);
+        free(client);
+        return CANNOT_MAP_MEMORY;
+    }
+
+    client->ring = mmap(0x00, sizeof(DaemonRing), PROT_READ | PROT_WRITE, MAP_SHARED, ring_file, 0);
+    close(ring_file);
+
+    if(client->ring == MAP_FAILED)
+    {
+        close(client->wake_file);
+        close(client->socket_file);
+        free(client);
+        return CANNOT_MAP_MEMORY;
+    }
+
+    *daemon_client = client;
+
+    return SUCCESS;
+}
+
+StatusCode run_daemon_commands(DaemonClient* daemon_client, DaemonCommand* daemon_commands, int command_count)
+{
+    DaemonRing* ring = daemon_client->ring;
+    unsigned int head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    unsigned int first;
+    uint64_t wake = 1;
+    struct pollfd socket_poll;
+    int batch;
+    int spins;
+    int i;
+
+    while(command_count > 0)
+    {
+        // Every earlier command has completed, so the whole ring is free
+        batch = command_count < DAEMON_RING_SIZE ? command_count : DAEMON_RING_SIZE;
+        first = head;
+
+        for(i = 0; i < batch; i++)
+        {
+            ring->commands[(head + i) % DAEMON_RING_SIZE] = daemon_commands[i];
+        }
+
+        head += batch;
+        atomic_store_explicit(&ring->head, head, memory_order_release);
+
+        // Only wake the daemon with a system call if it went to sleep
+        atomic_thread_fence(memory_order_seq_cst);
+
+        if(atomic_load_explicit(&ring->daemon_sleeping, memory_order_relaxed) != 0)
+        {
+            if(write(daemon_client->wake_file, &wake, sizeof(wake)) != sizeof(wake))
+            {
+                return REGISTER_FAILURE;
+            }
+        }
+
+        // Wait for the daemon to complete the batch
+        spins = 0;
+
+        while(atomic_load_explicit(&ring->tail, memory_order_acquire) != head)
+        {
+            if(++spins >= DAEMON_CLIENT_SPINS)
+            {
+                // The daemon never writes to the socket, so any event on it means the daemon has gone away
+                socket_poll.fd = daemon_client->socket_file;
+                socket_poll.events = POLLIN;
+                socket_poll.revents = 0;
+
+                if(poll(&socket_poll, 1, 0) > 0 && 
+                   atomic_load_explicit(&ring->tail, memory_order_acquire) != head)
+                {
+                    return REGISTER_FAILURE;
+                }
+
+                sched_yield();
+                spins = 0;
+            }
+        }
+
+        for(i = 0; i < batch; i++)
+        {
+            daemon_commands[i] = ring->commands[(first + i) % DAEMON_RING_SIZE];
+        }
+
+        daemon_commands += batch;
+        command_count -= batch;
+    }
+
+    return SUCCESS;
+}
+
+void disconnect_gpio_daemon(DaemonClient* daemon_client)
+{
+    munmap(daemon_client->ring, sizeof(DaemonRing));
+    close(daemon_client->wake_file);
+    close(daemon_client->socket_file);
+    free(daemon_client);
+}
+
+static bool receive_files(int socket_file, int* ring_file, int* wake_file)
+{
+    char data;
+    char control[CMSG_SPACE(2 * sizeof(int))];
+    struct iovec vector = {&data, sizeof(data)};
+    struct msghdr message;
+    struct cmsghdr* control_message;
+    int files[2];
+
+    memset(&message, 0x00, sizeof(message));
+    message.msg_iov = &vector;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+
+    if(recvmsg(socket_file, &message, MSG_CMSG_CLOEXEC) != 1)
+    {
+        return false;
+    }
+
+    control_message = CMSG_FIRSTHDR(&message);
+
+    if(control_message == 0x00 || control_message->cmsg_type != SCM_RIGHTS || 
+       control_message->cmsg_len != CMSG_LEN(2 * sizeof(int)))
+    {
+        return false;
+    }
+
+    memcpy(files, CMSG_DATA(control_message), sizeof(files));
+    *ring_file = files[0];
+    *wake_file = files[1];
+
+    return true;
+}
@@ -0,0 +1,138 @@
+/*
+ * File:        client.h
+ * Description: Definition of the GPIO daemon protocol and the client functions used to talk to the daemon.
+ * Programmer:  tnewman
+ * Date:        Oct 16, 2026
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 Thomas Newman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CLIENT_H
+#define CLIENT_H
+
+#include "gpio.h"
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+/*
+ * Configuration
+ */
+#define DAEMON_SOCKET_PATH "/run/pio.sock"
+#define DAEMON_RING_SIZE 256
+#define DAEMON_CLIENT_SPINS 1000
+#define DAEMON_CACHE_LINE_SIZE 64
+
+/*
+ * Daemon Protocol
+ *
+ * The daemon (pio_daemon) initializes the library once and owns the register mapping. A client connects to the 
+ * daemon's Unix socket and receives two file descriptors: a shared memory ring and an eventfd. From then on, the 
+ * client pushes commands into the ring and the daemon executes them and writes the results back into the same 
+ * slots. The ring has a single producer (the client) and a single consumer (the daemon), so no locks or system calls 
+ * are needed while the daemon is busy. When the daemon runs out of work it sets daemon_sleeping and sleeps in poll(); 
+ * a client that sees the flag after pushing commands writes to the eventfd to wake it. The socket stays open for the 
+ * life of the client, so the daemon notices when the client goes away.
+ */
+
+/*
+ * Name: DaemonOperation
+ * Description: DaemonOperation specifies what a daemon command does.
+ */
+typedef enum {
+    DAEMON_SET_PIN, // set_gpio_pin(pin_number, pin_type)
+    DAEMON_CLEAR_PIN, // clear_gpio_pin(pin_number, pin_type)
+    DAEMON_GET_PIN, // get_gpio_pin(pin_number, pin_type), the value is returned in pin_values
+    DAEMON_SET_MODE, // set_gpio_pin_mode(pin_number, pin_type), the PinMode is passed in pin_values
+    DAEMON_WRITE_MASK, // write_gpio_mask(pin_mask, pin_values, pin_type)
+    DAEMON_GET_LEVELS // get_gpio_levels(pin_mask, pin_type), the levels are returned in pin_values
+} DaemonOperation;
+
+/*
+ * Name: DaemonCommand
+ * Description: One command in a daemon ring. The daemon writes status and, for reads, pin_values back in place.
+ */
+typedef struct {
+    uint32_t operation; // The DaemonOperation to run.
+    int32_t pin_number; // The GPIO pin number for single pin operations.
+    uint32_t pin_type; // The PinType of pin_number and pin_mask.
+    uint32_t status; // The StatusCode of the operation (written by the daemon).
+    PinMask pin_mask; // The GPIO pins for mask operations.
+    PinMask pin_values; // Operation input or output, see DaemonOperation.
+} DaemonCommand;
+
+/*
+ * Name: DaemonRing
+ * Description: The shared memory of one client. head counts the commands pushed by the client and tail counts the 
+ *              commands completed by the daemon. They only ever increase and are masked when used.
+ */
+typedef struct {
+    _Alignas(DAEMON_CACHE_LINE_SIZE) atomic_uint head; // Written by the client.
+    _Alignas(DAEMON_CACHE_LINE_SIZE) atomic_uint tail; // Written by the daemon.
+    _Alignas(DAEMON_CACHE_LINE_SIZE) atomic_uint daemon_sleeping; // Set by the daemon before it sleeps.
+    _Alignas(DAEMON_CACHE_LINE_SIZE) DaemonCommand commands[DAEMON_RING_SIZE];
+} DaemonRing;
+
+/*
+ * Name: DaemonClient
+ * Description: A connection to the daemon.
+ */
+typedef struct DaemonClient DaemonClient;
+
+/*
+ * Name: connect_gpio_daemon
+ * Description: Connects to the daemon and maps the shared memory ring it creates for this client.
+ * Note: initialize_gpio is not needed (and root is not needed) to use the daemon.
+ * Parameters:
+ *       socket_path[in] - Path of the daemon's socket, or 0x00 for DAEMON_SOCKET_PATH.
+ *       daemon_client[out] - The connection.
+ * Returns: Result of the operation. CANNOT_MAP_MEMORY if the daemon cannot be reached or the ring cannot be mapped.
+ */
+StatusCode connect_gpio_daemon(const char* socket_path, DaemonClient** daemon_client);
+
+/*
+ * Name: run_daemon_commands
+ * Description: Pushes a batch of commands into the ring, waits for the daemon to complete them, and copies the 
+ *              status and results back into the batch. Batches larger than the ring are pushed in pieces.
+ * Note: Only one thread may use a connection at a time.
+ * Parameters:
+ *       daemon_client[in] - The connection.
+ *       daemon_commands[in,out] - The commands to run. status and pin_values are filled in.
+ *       command_count[in] - Number of commands.
+ * Returns: Result of the operation (REGISTER_FAILURE if the daemon has gone away). The result of each command is in 
+ *          its status.
+ */
+StatusCode run_daemon_commands(DaemonClient* daemon_client, DaemonCommand* daemon_commands, int command_count);
+
+/*
+ * Name: disconnect_gpio_daemon
+ * Description: Unmaps the ring and closes the connection.
+ * Parameters:
+ *       daemon_client[in] - The connection.
+ * Returns: None
+ */
+void disconnect_gpio_daemon(DaemonClient* daemon_client);
+
+#endif /* CLIENT_H_ */
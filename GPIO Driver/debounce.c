@@ -0,0 +1,109 @@
+/*
+ * File:        debounce.c
+ * Description: Bit-parallel debounce filter implementation.
+ * Programmer:  tnewman
+ * Date:        Oct 16, 2026
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 Thomas Newman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "debounce.h"
+
+#include <string.h>
+
+StatusCode open_gpio_debouncer(PinMask pin_mask, PinType pin_type, unsigned int sample_count, Debouncer* debouncer)
+{
+    StatusCode status;
+
+    if(sample_count < 1 || sample_count > DEBOUNCE_MAX_SAMPLES)
+    {
+        return UNSUPPORTED;
+    }
+
+    status = set_gpio_mask_mode(pin_mask, pin_type, MODE_INPUT);
+
+    if(status != SUCCESS)
+    {
+        return status;
+    }
+
+    memset(debouncer, 0x00, sizeof(Debouncer));
+    debouncer->pin_mask = pin_mask;
+    debouncer->pin_type = pin_type;
+    debouncer->sample_count = sample_count;
+
+    // The current levels are taken as stable
+    return get_gpio_levels(pin_mask, pin_type, &debouncer->stable_levels);
+}
+
+StatusCode update_gpio_debouncer(Debouncer* debouncer)
+{
+    PinMask levels;
+    StatusCode status;
+
+    status = get_gpio_levels(debouncer->pin_mask, debouncer->pin_type, &levels);
+
+    if(status != SUCCESS)
+    {
+        return status;
+    }
+
+    debounce_gpio_levels(debouncer, levels);
+
+    return SUCCESS;
+}
+
+void debounce_gpio_levels(Debouncer* debouncer, PinMask levels)
+{
+    PinMask different = (levels ^ debouncer->stable_levels) & debouncer->pin_mask;
+    PinMask carry = different;
+    PinMask sum;
+    PinMask expired = different;
+    int bit;
+
+    for(bit = 0; bit < DEBOUNCE_COUNTER_BITS; bit++)
+    {
+        // Pins that agree with their stable level start counting again from zero
+        debouncer->counters[bit] &= different;
+
+        // Add one to the counter of every pin that disagrees (a ripple carry across the bit planes)
+        sum = debouncer->counters[bit] ^ carry;
+        carry &= debouncer->counters[bit];
+        debouncer->counters[bit] = sum;
+
+        // A counter has expired when every bit plane matches sample_count
+        expired &= (debouncer->sample_count >> bit) & 0x01 ? sum : ~sum;
+    }
+
+    // Accept the new level of every expired pin and reset its counter
+    debouncer->stable_levels ^= expired;
+    debouncer->rising_edges = expired & debouncer->stable_levels;
+    debouncer->falling_edges = expired & ~debouncer->stable_levels;
+
+    for(bit = 0; bit < DEBOUNCE_COUNTER_BITS; bit++)
+    {
+        debouncer->counters[bit] &= ~expired;
+    }
+}
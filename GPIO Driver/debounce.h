@@ -0,0 +1,93 @@
+/*
+ * File:        debounce.h
+ * Description: Definition of the bit-parallel debounce filter for GPIO inputs.
+ * Programmer:  tnewman
+ * Date:        Oct 16, 2026
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 Thomas Newman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef DEBOUNCE_H
+#define DEBOUNCE_H
+
+#include "gpio.h"
+
+/*
+ * Configuration
+ */
+#define DEBOUNCE_COUNTER_BITS 4
+#define DEBOUNCE_MAX_SAMPLES ((1 << DEBOUNCE_COUNTER_BITS) - 1)
+
+/*
+ * Name: Debouncer
+ * Description: Debounce state for a group of pins. A pin only changes its stable level after sample_count 
+ *              consecutive samples disagree with it. Each pin has a counter of DEBOUNCE_COUNTER_BITS bits, stored 
+ *              bit-sliced: counters[k] holds bit k of the counter of every pin, so one sample updates every counter 
+ *              with a few bitwise operations on whole masks. The masks use the PinType the debouncer was opened with.
+ */
+typedef struct {
+    PinMask pin_mask; // Pins being debounced.
+    PinType pin_type; // Numbering convention of the masks.
+    unsigned int sample_count; // Consecutive samples needed to accept a new level.
+    PinMask stable_levels; // Debounced levels of the pins.
+    PinMask rising_edges; // Pins that became stable high on the last sample.
+    PinMask falling_edges; // Pins that became stable low on the last sample.
+    PinMask counters[DEBOUNCE_COUNTER_BITS]; // Bit-sliced counters of samples that disagreed with stable_levels.
+} Debouncer;
+
+/*
+ * Name: open_gpio_debouncer
+ * Description: Switches a group of pins to input and starts debouncing them from their current levels.
+ * Note: Must be called after initialize_gpio.
+ * Parameters:
+ *       pin_mask[in] - The pins to debounce.
+ *       pin_type[in] - The numbering convention used to identify the pins.
+ *       sample_count[in] - Consecutive samples needed to accept a new level (1 to DEBOUNCE_MAX_SAMPLES).
+ *       debouncer[out] - The debounce state.
+ * Returns: Result of the operation. UNSUPPORTED if sample_count is out of range.
+ */
+StatusCode open_gpio_debouncer(PinMask pin_mask, PinType pin_type, unsigned int sample_count, Debouncer* debouncer);
+
+/*
+ * Name: update_gpio_debouncer
+ * Description: Takes one snapshot of the levels and feeds it to the debouncer. Call at a fixed rate; the debounce 
+ *              time is sample_count times the sample period.
+ * Parameters:
+ *       debouncer[in,out] - The debounce state.
+ * Returns: Result of the operation.
+ */
+StatusCode update_gpio_debouncer(Debouncer* debouncer);
+
+/*
+ * Name: debounce_gpio_levels
+ * Description: Feeds a snapshot of levels taken elsewhere (for example a capture sample) to the debouncer.
+ * Parameters:
+ *       debouncer[in,out] - The debounce state.
+ *       levels[in] - The levels, in the numbering convention of the debouncer. Pins outside pin_mask are ignored.
+ * Returns: None
+ */
+void debounce_gpio_levels(Debouncer* debouncer, PinMask levels);
+
+#endif /* DEBOUNCE_H_ */
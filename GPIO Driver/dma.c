@@ -0,0 +1,496 @@
+/*
+ * File:        dma.c
+ * Description: Waveforms played by a DMA engine from a chain of control blocks, paced by the PWM controller.
+ * Programmer:  tnewman
+ * Date:        Oct 16, 2026
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 Thomas Newman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+#include "dma.h"
+#include "internal.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * Configuration
+ */
+#define MAILBOX_IOCTL _IOWR(100, 0, char*)
+#define MAILBOX_REQUEST 0x00000000
+#define MAILBOX_SUCCESS 0x80000000
+#define MAILBOX_ALLOCATE_MEMORY 0x0003000C
+#define MAILBOX_LOCK_MEMORY 0x0003000D
+#define MAILBOX_UNLOCK_MEMORY 0x0003000E
+#define MAILBOX_RELEASE_MEMORY 0x0003000F
+#define MAILBOX_MAX_ARGUMENTS 3
+#define MAILBOX_FLAGS_BCM2835 0x0C // L1 non-allocating alias (the BCM2835 has no direct alias for the ARM)
+#define MAILBOX_FLAGS 0x04 // Direct, uncached alias
+#define STEP_WORDS 8 // Words of step data (GPSET0, GPSET1, reserved, GPCLR0, GPCLR1, padding)
+#define STEP_OUTPUT_WORDS 5 // Words of step data copied to GPSET0 to GPCLR1
+
+/*
+ * Implementation Functions
+ *
+ * These functions are for internal use only.
+ */
+
+/*
+ * Name: call_mailbox
+ * Description: Sends a property request with one tag to the firmware.
+ * Parameters:
+ *       mailbox_file[in] - The open mailbox device.
+ *       tag[in] - The property tag.
+ *       arguments[in] - Arguments of the tag.
+ *       argument_count[in] - Number of arguments (at most MAILBOX_MAX_ARGUMENTS).
+ * Returns: The first word of the response, or 0 if the request failed.
+ */
+static uint32_t call_mailbox(int mailbox_file, uint32_t tag, const uint32_t* arguments, int argument_count);
+
+/*
+ * Name: allocate_memory
+ * Description: Allocates memory for a chain that the DMA engines can read: locked firmware memory mapped through 
+ *              /dev/mem, or ordinary memory in the simulation.
+ * Parameters:
+ *       dma_waveform[in,out] - The waveform to allocate the memory of (memory_size is set by the caller).
+ * Returns: Result of the operation.
+ */
+static StatusCode allocate_memory(DmaWaveform* dma_waveform);
+
+/*
+ * Name: release_memory
+ * Description: Unmaps and frees the memory of a waveform.
+ * Parameters:
+ *       dma_waveform[in,out] - The waveform.
+ * Returns: None
+ */
+static void release_memory(DmaWaveform* dma_waveform);
+
+/*
+ * Name: count_control_blocks
+ * Description: Counts the control blocks of a step: the output control block and one pacing control block for 
+ *              every DMA_PACING_TICKS_MAX ticks.
+ * Parameters:
+ *       ticks[in] - Ticks to wait after the output.
+ * Returns: Number of control blocks.
+ */
+static int count_control_blocks(unsigned int ticks);
+
+/*
+ * Name: dma_register
+ * Description: Gets a mapped register of a DMA channel.
+ * Parameters:
+ *       channel[in] - The DMA channel.
+ *       register_address[in] - Address of the register of channel 0.
+ * Returns: The mapped register.
+ */
+static volatile Register_Type* dma_register(int channel, unsigned int register_address);
+
+/*
+ * Name: pwm_register
+ * Description: Gets a mapped PWM register.
+ * Parameters:
+ *       register_address[in] - Address of the register.
+ * Returns: The mapped register.
+ */
+static volatile Register_Type* pwm_register(unsigned int register_address);
+
+StatusCode compile_gpio_dma_waveform(const WaveformStep* waveform_steps, int step_count, PinType pin_type, 
+        unsigned int tick, DmaWaveform** dma_waveform)
+{
+    DmaWaveform* compiled;
+    volatile DmaControlBlock* control_block;
+    volatile uint32_t* step_data;
+    uint32_t step_address;
+    uint32_t pacing_address;
+    PinMask broadcom_mask;
+    PinMask broadcom_values;
+    PinMask pin_mask = 0x00;
+    PinMask bits;
+    StatusCode status;
+    unsigned int ticks;
+    unsigned int chunk;
+    int control_block_count = 0;
+    int i;
+
+    // Check initialization
+    if(!check_init())
+    {
+        return NO_INIT;
+    }
+
+    if(peripheral_memory[DMA_REGION] == 0x00 || peripheral_memory[PWM_REGION] == 0x00 || 
+            peripheral_memory[CLOCK_REGION] == 0x00 || tick == 0 || step_count <= 0)
+    {
+        return UNSUPPORTED;
+    }
+
+    // All of the validation happens before the memory is allocated
+    for(i = 0; i < step_count; i++)
+    {
+        if(!mask_to_broadcom(waveform_steps[i].pin_mask, waveform_steps[i].pin_values, pin_type, &broadcom_mask, 
+                &broadcom_values))
+        {
+            return INVALID_PIN;
+        }
+
+        control_block_count += count_control_blocks((waveform_steps[i].duration + tick / 2) / tick);
+        pin_mask |= broadcom_mask;
+    }
+
+    compiled = malloc(sizeof(DmaWaveform));
+
+    if(compiled == 0x00)
+    {
+        return REGISTER_FAILURE;
+    }
+
+    // Control blocks, then the data of each step, then the word written to the PWM FIFO
+    compiled->channel = -1;
+    compiled->tick = tick;
+    compiled->control_block_count = control_block_count;
+    compiled->memory_size = (control_block_count + step_count + 1) * sizeof(DmaControlBlock);
+    compiled->memory_size = (compiled->memory_size + sysconf(_SC_PAGESIZE) - 1) & ~(sysconf(_SC_PAGESIZE) - 1);
+
+    status = allocate_memory(compiled);
+
+    if(status != SUCCESS)
+    {
+        free(compiled);
+        return status;
+    }
+
+    memset((void*) compiled->control_blocks, 0x00, compiled->memory_size);
+    step_data = (volatile uint32_t*) (compiled->control_blocks + control_block_count);
+    step_address = compiled->bus_address + control_block_count * sizeof(DmaControlBlock);
+    pacing_address = step_address + step_count * STEP_WORDS * sizeof(uint32_t);
+    control_block = compiled->control_blocks;
+
+    for(i = 0; i < step_count; i++)
+    {
+        mask_to_broadcom(waveform_steps[i].pin_mask, waveform_steps[i].pin_values, pin_type, &broadcom_mask, 
+                &broadcom_values);
+
+        // GPSET0, GPSET1, the reserved word between them and GPCLR0 (0 is harmless), GPCLR0, GPCLR1
+        bits = broadcom_mask & broadcom_values;
+        step_data[i * STEP_WORDS + 0] = (uint32_t) bits;
+        step_data[i * STEP_WORDS + 1] = (uint32_t) (bits >> REGISTER_SIZE);
+        bits = broadcom_mask & ~broadcom_values;
+        step_data[i * STEP_WORDS + 3] = (uint32_t) bits;
+        step_data[i * STEP_WORDS + 4] = (uint32_t) (bits >> REGISTER_SIZE);
+
+        control_block->transfer_information = DMA_TI_NO_WIDE_BURSTS | DMA_TI_WAIT_RESP | DMA_TI_SRC_INC | 
+                DMA_TI_DEST_INC;
+        control_block->source_address = step_address + i * STEP_WORDS * sizeof(uint32_t);
+        control_block->destination_address = calculate_bus_address(GPSET0);
+        control_block->transfer_length = STEP_OUTPUT_WORDS * sizeof(uint32_t);
+
+        // Each word written to the FIFO waits for the PWM controller to ask for one, which it does once per tick
+        ticks = (waveform_steps[i].duration + tick / 2) / tick;
+
+        while(ticks > 0)
+        {
+            chunk = ticks < DMA_PACING_TICKS_MAX ? ticks : DMA_PACING_TICKS_MAX;
+            control_block->next_control_block = compiled->bus_address + 
+                    (control_block + 1 - compiled->control_blocks) * sizeof(DmaControlBlock);
+            control_block++;
+            control_block->transfer_information = DMA_TI_NO_WIDE_BURSTS | DMA_TI_WAIT_RESP | DMA_TI_DEST_DREQ | 
+                    DMA_DREQ_PWM << DMA_TI_PERMAP_SHIFT;
+            control_block->source_address = pacing_address;
+            control_block->destination_address = calculate_bus_address(PWM_FIF1);
+            control_block->transfer_length = chunk * sizeof(uint32_t);
+            ticks -= chunk;
+        }
+
+        control_block->next_control_block = compiled->bus_address + 
+                (control_block + 1 - compiled->control_blocks) * sizeof(DmaControlBlock);
+        control_block++;
+    }
+
+    // The chain stops after the last control block unless it is started to repeat
+    compiled->last_control_block = control_block_count - 1;
+    compiled->control_blocks[compiled->last_control_block].next_control_block = 0x00;
+
+    if(!set_gpio_mask_function(pin_mask, GPIO_OUTPUT))
+    {
+        release_memory(compiled);
+        free(compiled);
+        return REGISTER_FAILURE;
+    }
+
+    *dma_waveform = compiled;
+
+    return SUCCESS;
+}
+
+StatusCode start_gpio_dma_waveform(DmaWaveform* dma_waveform, int channel, bool repeat)
+{
+    struct timespec reset_time = {0, DMA_RESET_TIME};
+    unsigned int pwm_clock;
+    unsigned int control;
+
+    // Check initialization
+    if(!check_init())
+    {
+        return NO_INIT;
+    }
+
+    if(channel < 0 || channel >= (peripheral_base == BCM2711_PERIPHERAL_BASE ? DMA4_FIRST_CHANNEL : DMA_CHANNEL_COUNT))
+    {
+        return UNSUPPORTED;
+    }
+
+    stop_gpio_dma_waveform(dma_waveform);
+    dma_waveform->control_blocks[dma_waveform->last_control_block].next_control_block = repeat ? 
+            dma_waveform->bus_address : 0x00;
+
+    // PWM channel 0 paces the chain: its FIFO asks for a word once per tick
+    pthread_mutex_lock(&peripheral_lock);
+    pwm_clock = start_pwm_clock();
+
+    if(pwm_clock == 0 || (uint64_t) dma_waveform->tick * pwm_clock < 1000000000 / 2)
+    {
+        pthread_mutex_unlock(&peripheral_lock);
+        return UNSUPPORTED;
+    }
+
+    control = *pwm_register(PWM_CTL) & ~PWM_CHANNEL_BITS;
+    *pwm_register(PWM_CTL) = control;
+    *pwm_register(PWM_DMAC) = PWM_DMAC_ENAB | DMA_PWM_PANIC_THRESHOLD << PWM_DMAC_PANIC_SHIFT | 
+            DMA_PWM_DREQ_THRESHOLD << PWM_DMAC_DREQ_SHIFT;
+    *pwm_register(PWM_RNG1) = (unsigned int) (((uint64_t) dma_waveform->tick * pwm_clock + 1000000000 / 2) / 
+            1000000000);
+    *pwm_register(PWM_CTL) = control | PWM_CLRF;
+    *pwm_register(PWM_CTL) = control | PWM_USEF1 | PWM_PWEN1;
+    pthread_mutex_unlock(&peripheral_lock);
+
+    // Reset the channel and clear anything left over from its last user before starting the chain
+    *dma_register(channel, DMA_CS) = DMA_CS_RESET;
+    nanosleep(&reset_time, 0x00);
+    *dma_register(channel, DMA_CS) = DMA_CS_INT | DMA_CS_END;
+    *dma_register(channel, DMA_DEBUG) = DMA_DEBUG_ERRORS;
+    *dma_register(0, DMA_ENABLE) |= 1 << channel;
+    *dma_register(channel, DMA_CONBLK_AD) = dma_waveform->bus_address;
+    *dma_register(channel, DMA_CS) = DMA_CS_WAIT_FOR_OUTSTANDING_WRITES | 
+            DMA_PANIC_PRIORITY << DMA_CS_PANIC_PRIORITY_SHIFT | DMA_PRIORITY << DMA_CS_PRIORITY_SHIFT | DMA_CS_ACTIVE;
+    dma_waveform->channel = channel;
+
+    return SUCCESS;
+}
+
+bool check_gpio_dma_waveform(const DmaWaveform* dma_waveform)
+{
+    if(!check_init() || dma_waveform->channel < 0)
+    {
+        return false;
+    }
+
+    return (*dma_register(dma_waveform->channel, DMA_CS) & DMA_CS_ACTIVE) != 0;
+}
+
+StatusCode stop_gpio_dma_waveform(DmaWaveform* dma_waveform)
+{
+    struct timespec reset_time = {0, DMA_RESET_TIME};
+
+    // Check initialization
+    if(!check_init())
+    {
+        return NO_INIT;
+    }
+
+    if(dma_waveform->channel < 0)
+    {
+        return SUCCESS;
+    }
+
+    // Pause the channel so it finishes the current write, then reset it
+    *dma_register(dma_waveform->channel, DMA_CS) = 0x00;
+    nanosleep(&reset_time, 0x00);
+    *dma_register(dma_waveform->channel, DMA_CS) = DMA_CS_RESET;
+    dma_waveform->channel = -1;
+
+    pthread_mutex_lock(&peripheral_lock);
+    *pwm_register(PWM_CTL) &= ~PWM_CHANNEL_BITS;
+    *pwm_register(PWM_DMAC) = 0x00;
+    pthread_mutex_unlock(&peripheral_lock);
+
+    return SUCCESS;
+}
+
+void free_gpio_dma_waveform(DmaWaveform* dma_waveform)
+{
+    stop_gpio_dma_waveform(dma_waveform);
+    release_memory(dma_waveform);
+    free(dma_waveform);
+}
+
+static uint32_t call_mailbox(int mailbox_file, uint32_t tag, const uint32_t* arguments, int argument_count)
+{
+    uint32_t message[6 + MAILBOX_MAX_ARGUMENTS] __attribute__((aligned(16)));
+    int i;
+
+    message[0] = sizeof(message);
+    message[1] = MAILBOX_REQUEST;
+    message[2] = tag;
+    message[3] = MAILBOX_MAX_ARGUMENTS * sizeof(uint32_t);
+    message[4] = argument_count * sizeof(uint32_t);
+
+    for(i = 0; i < MAILBOX_MAX_ARGUMENTS; i++)
+    {
+        message[5 + i] = i < argument_count ? arguments[i] : 0x00;
+    }
+
+    message[5 + MAILBOX_MAX_ARGUMENTS] = 0x00;
+
+    if(ioctl(mailbox_file, MAILBOX_IOCTL, message) < 0 || message[1] != MAILBOX_SUCCESS)
+    {
+        return 0x00;
+    }
+
+    return message[5];
+}
+
+static StatusCode allocate_memory(DmaWaveform* dma_waveform)
+{
+    uint32_t arguments[MAILBOX_MAX_ARGUMENTS];
+    int mailbox_file;
+    int memory_file;
+    void* memory;
+
+    dma_waveform->memory_handle = 0x00;
+    dma_waveform->bus_address = 0x00;
+    dma_waveform->control_blocks = 0x00;
+
+    if(backend == SIMULATED_BACKEND)
+    {
+        memory = mmap(0x00, dma_waveform->memory_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+        if(memory == MAP_FAILED)
+        {
+            return REGISTER_FAILURE;
+        }
+
+        dma_waveform->control_blocks = memory;
+        dma_waveform->bus_address = DMA_SIMULATED_BUS_ADDRESS;
+
+        return SUCCESS;
+    }
+
+    mailbox_file = open(DMA_MAILBOX_FILE, O_RDWR);
+
+    if(mailbox_file < 0)
+    {
+        return CANNOT_MAP_MEMORY;
+    }
+
+    // The firmware hands out physically contiguous memory, and locking it gives its bus address
+    arguments[0] = dma_waveform->memory_size;
+    arguments[1] = sysconf(_SC_PAGESIZE);
+    arguments[2] = peripheral_base == BCM2835_PERIPHERAL_BASE ? MAILBOX_FLAGS_BCM2835 : MAILBOX_FLAGS;
+    dma_waveform->memory_handle = call_mailbox(mailbox_file, MAILBOX_ALLOCATE_MEMORY, arguments, 3);
+
+    if(dma_waveform->memory_handle != 0x00)
+    {
+        dma_waveform->bus_address = call_mailbox(mailbox_file, MAILBOX_LOCK_MEMORY, &dma_waveform->memory_handle, 1);
+    }
+
+    close(mailbox_file);
+
+    if(dma_waveform->memory_handle == 0x00 || dma_waveform->bus_address == 0x00)
+    {
+        release_memory(dma_waveform);
+        return CANNOT_MAP_MEMORY;
+    }
+
+    // O_SYNC maps the memory uncached, so stores reach the memory the DMA engines read
+    memory_file = open(MEMORY_FILE, O_RDWR | O_SYNC);
+    memory = MAP_FAILED;
+
+    if(memory_file >= 0)
+    {
+        memory = mmap(0x00, dma_waveform->memory_size, PROT_READ | PROT_WRITE, MAP_SHARED, memory_file, 
+                dma_waveform->bus_address & ~BUS_ALIAS_BITS);
+        close(memory_file);
+    }
+
+    if(memory == MAP_FAILED)
+    {
+        release_memory(dma_waveform);
+        return CANNOT_MAP_MEMORY;
+    }
+
+    dma_waveform->control_blocks = memory;
+
+    return SUCCESS;
+}
+
+static void release_memory(DmaWaveform* dma_waveform)
+{
+    int mailbox_file;
+
+    if(dma_waveform->control_blocks != 0x00)
+    {
+        munmap((void*) dma_waveform->control_blocks, dma_waveform->memory_size);
+        dma_waveform->control_blocks = 0x00;
+    }
+
+    if(dma_waveform->memory_handle == 0x00)
+    {
+        return;
+    }
+
+    mailbox_file = open(DMA_MAILBOX_FILE, O_RDWR);
+
+    if(mailbox_file >= 0)
+    {
+        call_mailbox(mailbox_file, MAILBOX_UNLOCK_MEMORY, &dma_waveform->memory_handle, 1);
+        call_mailbox(mailbox_file, MAILBOX_RELEASE_MEMORY, &dma_waveform->memory_handle, 1);
+        close(mailbox_file);
+    }
+
+    dma_waveform->memory_handle = 0x00;
+}
+
+static int count_control_blocks(unsigned int ticks)
+{
+    return 1 + (ticks + DMA_PACING_TICKS_MAX - 1) / DMA_PACING_TICKS_MAX;
+}
+
+static volatile Register_Type* dma_register(int channel, unsigned int register_address)
+{
+    return peripheral_memory[DMA_REGION] + 
+            calculate_region_offset(register_address + channel * DMA_CHANNEL_STRIDE, DMA_MEMORY_START);
+}
+
+static volatile Register_Type* pwm_register(unsigned int register_address)
+{
+    return peripheral_memory[PWM_REGION] + calculate_region_offset(register_address, PWM_MEMORY_START);
+}
@@ -0,0 +1,123 @@
+/*
+ * File:        dma.h
+ * Description: Waveforms played by a DMA engine from a chain of control blocks, paced by the PWM controller.
+ * Programmer:  tnewman
+ * Date:        Oct 16, 2026
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 Thomas Newman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+#ifndef DMA_H
+#define DMA_H
+
+#include "gpio.h"
+#include "waveform.h"
+
+#include <stdbool.h>
+
+/*
+ * Configuration
+ */
+#define DMA_DEFAULT_CHANNEL 7 // A lite channel that the firmware leaves free on every board
+#define DMA_MAILBOX_FILE "/dev/vcio"
+#define DMA_PACING_TICKS_MAX 16383 // Ticks per pacing control block (lite channels transfer at most 65535 bytes)
+#define DMA_PRIORITY 8
+#define DMA_PANIC_PRIORITY 8
+#define DMA_PWM_PANIC_THRESHOLD 7
+#define DMA_PWM_DREQ_THRESHOLD 3
+#define DMA_RESET_TIME 10000 // Nanoseconds to wait for a channel to reset
+#define DMA_SIMULATED_BUS_ADDRESS 0xC0000000 // Bus address given to the memory of waveforms in the simulation
+
+/*
+ * Name: DmaWaveform
+ * Description: A waveform compiled into a chain of DMA control blocks. Each step is one control block that copies 
+ *              five words (set masks, a reserved word, and clear masks) to GPSET0 to GPCLR1, followed by control 
+ *              blocks that write to the PWM FIFO once per tick. The FIFO only accepts a word per PWM period, so the 
+ *              engine waits out the delay without the CPU.
+ */
+typedef struct DmaWaveform DmaWaveform;
+
+/*
+ * Name: compile_gpio_dma_waveform
+ * Description: Validates a waveform description once, switches its pins to output mode, and builds the control block 
+ *              chain in memory that the DMA engines can read.
+ * Note: Must be called after initialize_gpio. MEMORY_BACKEND allocates the memory from the firmware through the 
+ *       mailbox. SIMULATED_BACKEND uses ordinary memory at DMA_SIMULATED_BUS_ADDRESS, so the chain can be checked 
+ *       with step_simulated_dma (simulator.h).
+ * Parameters:
+ *       waveform_steps[in] - The steps of the waveform. Durations are rounded to whole ticks.
+ *       step_count[in] - Number of steps.
+ *       pin_type[in] - The numbering convention used by the pin masks of the steps.
+ *       tick[in] - Length of a pacing tick in nanoseconds. It is rounded to whole PWM clock cycles when the waveform 
+ *                  is started.
+ *       dma_waveform[out] - The compiled waveform.
+ * Returns: Result of the operation.
+ */
+StatusCode compile_gpio_dma_waveform(const WaveformStep* waveform_steps, int step_count, PinType pin_type, 
+        unsigned int tick, DmaWaveform** dma_waveform);
+
+/*
+ * Name: start_gpio_dma_waveform
+ * Description: Starts the pacing on PWM channel 0 and a DMA channel on the chain of a compiled waveform. The call 
+ *              returns at once and the waveform plays without the CPU.
+ * Note: Pacing takes over PWM channel 0, so hardware PWM on GPIO12, GPIO18, GPIO40 cannot be used at the same time. 
+ *       The PWM FIFO accepts a few words at once, so the first delay is a few ticks short. Later delays are exact.
+ * Parameters:
+ *       dma_waveform[in] - The compiled waveform.
+ *       channel[in] - The DMA channel (DMA_DEFAULT_CHANNEL unless it is known to be free).
+ *       repeat[in] - true to loop the waveform until it is stopped, false to play it once.
+ * Returns: Result of the operation.
+ */
+StatusCode start_gpio_dma_waveform(DmaWaveform* dma_waveform, int channel, bool repeat);
+
+/*
+ * Name: check_gpio_dma_waveform
+ * Description: Checks whether a started waveform is still playing.
+ * Parameters:
+ *       dma_waveform[in] - The compiled waveform.
+ * Returns: true while the DMA channel is running the chain, otherwise false.
+ */
+bool check_gpio_dma_waveform(const DmaWaveform* dma_waveform);
+
+/*
+ * Name: stop_gpio_dma_waveform
+ * Description: Stops the DMA channel and the pacing. The pins keep the level they had last.
+ * Parameters:
+ *       dma_waveform[in] - The compiled waveform.
+ * Returns: Result of the operation.
+ */
+StatusCode stop_gpio_dma_waveform(DmaWaveform* dma_waveform);
+
+/*
+ * Name: free_gpio_dma_waveform
+ * Description: Stops a waveform if it is playing and frees it and its memory.
+ * Parameters:
+ *       dma_waveform[in] - The compiled waveform.
+ * Returns: None
+ */
+void free_gpio_dma_waveform(DmaWaveform* dma_waveform);
+
+#endif /* DMA_H_ */
@@ -0,0 +1,512 @@
+/*
+ * File:        edge.c
+ * Description: GPIO edge detection implementation.
+ * Programmer:  tnewman
+ * Date:        Oct 16, 2026
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 Thomas Newman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "edge.h"
+#include "internal.h"
+
+#include <linux/gpio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * Detect Enable Registers
+ *
+ * The registers for bank 0, in the same order as the EdgeType bits.
+ */
+static const unsigned int DETECT_REGISTERS[] = {GPREN0, GPFEN0, GPHEN0, GPLEN0, GPAREN0, GPAFEN0};
+
+/*
+ * Global Variables
+ */
+static int edge_types_enabled[GPIO_PIN_COUNT + 1]; // Events enabled on each Broadcom pin
+static int edge_files[GPIO_PIN_COUNT + 1]; // Kernel event file of each Broadcom pin
+static bool edge_file_open[GPIO_PIN_COUNT + 1]; // Whether each Broadcom pin uses a kernel event file
+
+/*
+ * Implementation Functions
+ *
+ * These functions are for internal use only.
+ */
+
+/*
+ * Name: open_line_event
+ * Description: Requests a kernel line event file for a Broadcom pin.
+ * Parameters:
+ *       broadcom_number[in] - The Broadcom pin to request events for.
+ *       edge_types[in] - The edges to request (EDGE_RISING and EDGE_FALLING only).
+ * Returns: true if the kernel event file was opened, otherwise false.
+ */
+static bool open_line_event(int broadcom_number, int edge_types);
+
+/*
+ * Name: write_detect_registers
+ * Description: Sets or clears the bit of a Broadcom pin in every detect enable register.
+ * Parameters:
+ *       broadcom_number[in] - The Broadcom pin to configure.
+ *       edge_types[in] - The events to enable. Every other event is disabled.
+ * Returns: None
+ */
+static void write_detect_registers(int broadcom_number, int edge_types);
+
+/*
+ * Name: clear_events
+ * Description: Clears event detect status bits. The hardware clears bits that are written with 1. The simulated 
+ *              registers are plain memory, so the bits are cleared directly instead.
+ * Parameters:
+ *       pin_events[in] - The Broadcom pins to clear the events of.
+ * Returns: None
+ */
+static void clear_events(PinMask pin_events);
+
+/*
+ * Name: wait_line_event
+ * Description: Waits for an event on a kernel event file.
+ * Parameters:
+ *       file_descriptor[in] - The kernel event file.
+ *       timeout[in] - Longest time to wait in milliseconds, or a negative number to wait forever.
+ *       edge_type[out] - The event that was detected.
+ * Returns: Result of the operation.
+ */
+static StatusCode wait_line_event(int file_descriptor, int timeout, EdgeType* edge_type);
+
+/*
+ * Name: poll_event_status
+ * Description: Polls the event detect status of a Broadcom pin adaptively until an event is detected.
+ * Parameters:
+ *       broadcom_number[in] - The Broadcom pin to wait on.
+ *       timeout[in] - Longest time to wait in milliseconds, or a negative number to wait forever.
+ *       edge_type[out] - The event that was detected.
+ * Returns: Result of the operation.
+ */
+static StatusCode poll_event_status(int broadcom_number, int timeout, EdgeType* edge_type);
+
+/*
+ * Name: get_milliseconds
+ * Description: Reads the monotonic clock.
+ * Parameters: None
+ * Returns: The current time in milliseconds.
+ */
+static long long get_milliseconds();
+
+StatusCode enable_gpio_edge(int pin_number, PinType pin_type, int edge_types)
+{
+    StatusCode status;
+    int broadcom_number;
+    bool poll_registers;
+
+    // Start from a pin without any events enabled
+    status = disable_gpio_edge(pin_number, pin_type);
+
+    if(status != SUCCESS)
+    {
+        return status;
+    }
+
+    pin_to_broadcom(pin_number, pin_type, &broadcom_number);
+
+    if((edge_types & ~(EDGE_RISING | EDGE_FALLING | EDGE_HIGH | EDGE_LOW | EDGE_ASYNC_RISING | EDGE_ASYNC_FALLING)) != 0)
+    {
+        return UNSUPPORTED;
+    }
+
+    // The kernel's GPIO driver acknowledges GPEDS from its own interrupt handler, which would swallow polled events, 
+    // so the registers are only programmed directly when no GPIO character device owns them
+    poll_registers = backend == SIMULATED_BACKEND || access(GPIO_CHIP_FILE, F_OK) != 0;
+
+    // Level and asynchronous events have no kernel line event equivalent
+    if(!poll_registers && (edge_types & ~EDGE_BOTH) != 0)
+    {
+        return UNSUPPORTED;
+    }
+
+    // Events are only detected on inputs
+    if(!set_gpio_pin_function(broadcom_number, GPIO_INPUT))
+    {
+        return REGISTER_FAILURE;
+    }
+
+    if(edge_types == EDGE_NONE)
+    {
+        return SUCCESS;
+    }
+
+    if(!poll_registers)
+    {
+        if(!open_line_event(broadcom_number, edge_types))
+        {
+            return UNSUPPORTED;
+        }
+
+        edge_types_enabled[broadcom_number] = edge_types;
+
+        return SUCCESS;
+    }
+
+    // Otherwise the registers are programmed directly and polled
+    edge_types_enabled[broadcom_number] = edge_types;
+    write_detect_registers(broadcom_number, edge_types);
+    clear_events((PinMask) 1 << broadcom_number);
+
+    return SUCCESS;
+}
+
+StatusCode disable_gpio_edge(int pin_number, PinType pin_type)
+{
+    int broadcom_number;
+
+    // Check initialization
+    if(!check_init())
+    {
+        return NO_INIT;
+    }
+
+    // Attempt to get the Broadcom pin number
+    if(!pin_to_broadcom(pin_number, pin_type, &broadcom_number))
+    {
+        return INVALID_PIN;
+    }
+
+    if(edge_file_open[broadcom_number])
+    {
+        close(edge_files[broadcom_number]);
+        edge_file_open[broadcom_number] = false;
+    }
+    else if(edge_types_enabled[broadcom_number] != EDGE_NONE)
+    {
+        write_detect_registers(broadcom_number, EDGE_NONE);
+        clear_events((PinMask) 1 << broadcom_number);
+    }
+
+    edge_types_enabled[broadcom_number] = EDGE_NONE;
+
+    return SUCCESS;
+}
+
+StatusCode wait_gpio_edge(int pin_number, PinType pin_type, int timeout, EdgeType* edge_type)
+{
+    int broadcom_number;
+
+    // Check initialization
+    if(!check_init())
+    {
+        return NO_INIT;
+    }
+
+    // Attempt to get the Broadcom pin number
+    if(!pin_to_broadcom(pin_number, pin_type, &broadcom_number))
+    {
+        return INVALID_PIN;
+    }
+
+    if(edge_file_open[broadcom_number])
+    {
+        return wait_line_event(edge_files[broadcom_number], timeout, edge_type);
+    }
+
+    if(edge_types_enabled[broadcom_number] == EDGE_NONE)
+    {
+        return UNSUPPORTED;
+    }
+
+    return poll_event_status(broadcom_number, timeout, edge_type);
+}
+
+StatusCode get_gpio_edge_fd(int pin_number, PinType pin_type, int* file_descriptor)
+{
+    int broadcom_number;
+
+    // Check initialization
+    if(!check_init())
+    {
+        return NO_INIT;
+    }
+
+    // Attempt to get the Broadcom pin number
+    if(!pin_to_broadcom(pin_number, pin_type, &broadcom_number))
+    {
+        return INVALID_PIN;
+    }
+
+    if(!edge_file_open[broadcom_number])
+    {
+        return UNSUPPORTED;
+    }
+
+    *file_descriptor = edge_files[broadcom_number];
+
+    return SUCCESS;
+}
+
+StatusCode get_gpio_events(PinMask* pin_events)
+{
+    // Check initialization
+    if(!check_init())
+    {
+        return NO_INIT;
+    }
+
+    *pin_events = read_register_pair(GPEDS0);
+
+    if(*pin_events != 0x00)
+    {
+        clear_events(*pin_events);
+    }
+
+    return SUCCESS;
+}
+
+void close_edge_files()
+{
+    int broadcom_number;
+
+    for(broadcom_number = 0; broadcom_number <= GPIO_PIN_COUNT; broadcom_number++)
+    {
+        if(edge_file_open[broadcom_number])
+        {
+            close(edge_files[broadcom_number]);
+            edge_file_open[broadcom_number] = false;
+        }
+
+        edge_types_enabled[broadcom_number] = EDGE_NONE;
+    }
+}
+
+static bool open_line_event(int broadcom_number, int edge_types)
+{
+    struct gpioevent_request request;
+    int chip_file;
+    int result;
+
+    chip_file = open(GPIO_CHIP_FILE, O_RDONLY | O_CLOEXEC);
+
+    if(chip_file < 0)
+    {
+        return false;
+    }
+
+    memset(&request, 0x00, sizeof(request));
+    request.lineoffset = broadcom_number;
+    request.handleflags = GPIOHANDLE_REQUEST_INPUT;
+    request.eventflags = ((edge_types & EDGE_RISING) ? GPIOEVENT_REQUEST_RISING_EDGE : 0) | 
+            ((edge_types & EDGE_FALLING) ? GPIOEVENT_REQUEST_FALLING_EDGE : 0);
+    strncpy(request.consumer_label, EDGE_CONSUMER_LABEL, sizeof(request.consumer_label) - 1);
+
+    result = ioctl(chip_file, GPIO_GET_LINEEVENT_IOCTL, &request);
+    close(chip_file);
+
+    if(result < 0 || request.fd <= 0)
+    {
+        return false;
+    }
+
+    edge_files[broadcom_number] = request.fd;
+    edge_file_open[broadcom_number] = true;
+
+    return true;
+}
+
+static void write_detect_registers(int broadcom_number, int edge_types)
+{
+    volatile Register_Type* detect_register;
+    unsigned int bit_mask = 0x01 << (broadcom_number % REGISTER_SIZE);
+    unsigned int register_address;
+    int i;
+
+    for(i = 0; i < (int) (sizeof(DETECT_REGISTERS) / sizeof(DETECT_REGISTERS[0])); i++)
+    {
+        register_address = DETECT_REGISTERS[i] + (broadcom_number / REGISTER_SIZE) * sizeof(Register_Type);
+        detect_register = gpio_memory + calculate_offset(register_address);
+
+        // Every pin in the bank shares the register
+        lock_register(register_address);
+
+        if((edge_types & (0x01 << i)) != 0)
+        {
+            *detect_register |= bit_mask;
+        }
+        else
+        {
+            *detect_register &= ~bit_mask;
+        }
+
+        unlock_register(register_address);
+    }
+}
+
+static void clear_events(PinMask pin_events)
+{
+    volatile Register_Type* status_register = gpio_memory + calculate_offset(GPEDS0);
+
+    if(backend == SIMULATED_BACKEND)
+    {
+        lock_register(GPEDS0);
+        status_register[0] &= ~(unsigned int) pin_events;
+        status_register[1] &= ~(unsigned int) (pin_events >> REGISTER_SIZE);
+        unlock_register(GPEDS0);
+    }
+    else
+    {
+        status_register[0] = (unsigned int) pin_events;
+        status_register[1] = (unsigned int) (pin_events >> REGISTER_SIZE);
+    }
+}
+
+static StatusCode wait_line_event(int file_descriptor, int timeout, EdgeType* edge_type)
+{
+    struct pollfd poll_file;
+    struct gpioevent_data event;
+    long long deadline = 0;
+    int remaining = timeout;
+    int result;
+
+    poll_file.fd = file_descriptor;
+    poll_file.events = POLLIN | POLLPRI;
+
+    if(timeout >= 0)
+    {
+        deadline = get_milliseconds() + timeout;
+    }
+
+    // Sleep in the kernel until the interrupt arrives, going back to sleep for the rest of the timeout if a signal 
+    // interrupts the wait
+    do
+    {
+        poll_file.revents = 0x00;
+        result = poll(&poll_file, 1, remaining);
+
+        if(result < 0 && errno == EINTR && timeout >= 0)
+        {
+            remaining = (int) (deadline - get_milliseconds());
+            remaining = remaining > 0 ? remaining : 0;
+        }
+    } while(result < 0 && errno == EINTR);
+
+    if(result == 0)
+    {
+        return TIMED_OUT;
+    }
+
+    if(result < 0 || read(file_descriptor, &event, sizeof(event)) != sizeof(event))
+    {
+        return REGISTER_FAILURE;
+    }
+
+    *edge_type = (event.id == GPIOEVENT_EVENT_RISING_EDGE) ? EDGE_RISING : EDGE_FALLING;
+
+    return SUCCESS;
+}
+
+static StatusCode poll_event_status(int broadcom_number, int timeout, EdgeType* edge_type)
+{
+    volatile Register_Type* status_register;
+    volatile Register_Type* level_register;
+    unsigned int bit_mask = 0x01 << (broadcom_number % REGISTER_SIZE);
+    int edge_types = edge_types_enabled[broadcom_number];
+    int candidates;
+    long long deadline = 0;
+    long polls = 0;
+    struct timespec sleep_time = {0, EDGE_MIN_SLEEP};
+
+    status_register = gpio_memory + calculate_offset(GPEDS0) + broadcom_number / REGISTER_SIZE;
+    level_register = gpio_memory + calculate_offset(GPLEV0) + broadcom_number / REGISTER_SIZE;
+
+    if(timeout >= 0)
+    {
+        deadline = get_milliseconds() + timeout;
+    }
+
+    // Spin first for the lowest latency, then yield, then sleep for longer and longer between polls
+    while((*status_register & bit_mask) == 0)
+    {
+        polls++;
+
+        if(polls < EDGE_SPIN_POLLS)
+        {
+            continue;
+        }
+
+        if(timeout >= 0 && get_milliseconds() >= deadline)
+        {
+            return TIMED_OUT;
+        }
+
+        if(polls < EDGE_SPIN_POLLS + EDGE_YIELD_POLLS)
+        {
+            sched_yield();
+        }
+        else
+        {
+            nanosleep(&sleep_time, 0x00);
+
+            if(sleep_time.tv_nsec < EDGE_MAX_SLEEP)
+            {
+                sleep_time.tv_nsec *= 2;
+            }
+        }
+    }
+
+    clear_events((PinMask) 1 << broadcom_number);
+
+    // The current level tells which of the enabled events happened
+    if((*level_register & bit_mask) != 0)
+    {
+        candidates = edge_types & (EDGE_RISING | EDGE_ASYNC_RISING | EDGE_HIGH);
+    }
+    else
+    {
+        candidates = edge_types & (EDGE_FALLING | EDGE_ASYNC_FALLING | EDGE_LOW);
+    }
+
+    if(candidates == 0)
+    {
+        candidates = edge_types;
+    }
+
+    *edge_type = (EdgeType) (candidates & -candidates);
+
+    return SUCCESS;
+}
+
+static long long get_milliseconds()
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return time.tv_sec * 1000LL + time.tv_nsec / 1000000;
+}
@@ -0,0 +1,136 @@
+/*
+ * File:        edge.h
+ * Description: Definition of the GPIO edge detection functions, data types, and constants.
+ * Programmer:  tnewman
+ * Date:        Oct 16, 2026
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 Thomas Newman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef EDGE_H
+#define EDGE_H
+
+#include "gpio.h"
+
+/*
+ * Configuration
+ */
+#define GPIO_CHIP_FILE "/dev/gpiochip0"
+#define EDGE_CONSUMER_LABEL "pio"
+#define EDGE_SPIN_POLLS 1000
+#define EDGE_YIELD_POLLS 100
+#define EDGE_MIN_SLEEP 1000
+#define EDGE_MAX_SLEEP 1000000
+
+/*
+ * Name: EdgeType
+ * Description: EdgeType specifies the events that are detected on a pin. Values can be combined with a bitwise or.
+ */
+typedef enum {
+    EDGE_NONE = 0x00, // No events are detected.
+    EDGE_RISING = 0x01, // Rising edges, sampled with the system clock (GPREN).
+    EDGE_FALLING = 0x02, // Falling edges, sampled with the system clock (GPFEN).
+    EDGE_HIGH = 0x04, // A high level (GPHEN).
+    EDGE_LOW = 0x08, // A low level (GPLEN).
+    EDGE_ASYNC_RISING = 0x10, // Rising edges, not sampled, so very short pulses are detected (GPAREN).
+    EDGE_ASYNC_FALLING = 0x20, // Falling edges, not sampled, so very short pulses are detected (GPAFEN).
+    EDGE_BOTH = EDGE_RISING | EDGE_FALLING // Rising and falling edges.
+} EdgeType;
+
+/*
+ * Edge Detection
+ *
+ * When /dev/gpiochip0 exists, enable_gpio_edge requests a kernel line event file. The kernel takes the GPIO 
+ * interrupt, so wait_gpio_edge sleeps in poll() and the file can be added to an epoll set with get_gpio_edge_fd. 
+ * Level and asynchronous events have no line event equivalent and are UNSUPPORTED there: the kernel's pinctrl driver 
+ * acknowledges GPEDS from its own interrupt handler, so events polled from the registers next to it would be lost. 
+ * Only without a GPIO character device (or with simulated registers) are the detect enable registers programmed 
+ * directly, and wait_gpio_edge polls GPEDS adaptively: it spins for EDGE_SPIN_POLLS polls, yields for 
+ * EDGE_YIELD_POLLS polls, then sleeps between polls for EDGE_MIN_SLEEP nanoseconds, doubling up to EDGE_MAX_SLEEP.
+ */
+
+/*
+ * Name: enable_gpio_edge
+ * Description: Switches a GPIO pin to input mode and starts detecting events on it. Any events detected before are 
+ *              disabled first.
+ * Note: Must be called after initialize_gpio.
+ * Parameters:
+ *       pin_number[in] - The GPIO pin number to detect events on.
+ *       pin_type[in] - The numbering convention used to identify the GPIO pin.
+ *       edge_types[in] - The events to detect (EdgeType values combined with a bitwise or).
+ * Returns: Result of the operation.
+ */
+StatusCode enable_gpio_edge(int pin_number, PinType pin_type, int edge_types);
+
+/*
+ * Name: disable_gpio_edge
+ * Description: Stops detecting events on a GPIO pin and discards any pending event.
+ * Note: Must be called after initialize_gpio.
+ * Parameters:
+ *       pin_number[in] - The GPIO pin number to stop detecting events on.
+ *       pin_type[in] - The numbering convention used to identify the GPIO pin.
+ * Returns: Result of the operation.
+ */
+StatusCode disable_gpio_edge(int pin_number, PinType pin_type);
+
+/*
+ * Name: wait_gpio_edge
+ * Description: Waits for an event on a GPIO pin that was enabled with enable_gpio_edge.
+ * Note: Must be called after initialize_gpio.
+ * Parameters:
+ *       pin_number[in] - The GPIO pin number to wait on.
+ *       pin_type[in] - The numbering convention used to identify the GPIO pin.
+ *       timeout[in] - Longest time to wait in milliseconds, or a negative number to wait forever.
+ *       edge_type[out] - The event that was detected.
+ * Returns: Result of the operation. TIMED_OUT if no event was detected in time, UNSUPPORTED if events are not enabled 
+ *          on the pin.
+ */
+StatusCode wait_gpio_edge(int pin_number, PinType pin_type, int timeout, EdgeType* edge_type);
+
+/*
+ * Name: get_gpio_edge_fd
+ * Description: Gets the kernel event file of a GPIO pin, so it can be waited on with poll, select, or epoll. The file 
+ *              becomes readable when an event is pending, and each event can then be collected with wait_gpio_edge.
+ * Note: Must be called after initialize_gpio.
+ * Parameters:
+ *       pin_number[in] - The GPIO pin number to get the event file of.
+ *       pin_type[in] - The numbering convention used to identify the GPIO pin.
+ *       file_descriptor[out] - The kernel event file.
+ * Returns: Result of the operation. UNSUPPORTED if the pin is polled instead of using a kernel event file.
+ */
+StatusCode get_gpio_edge_fd(int pin_number, PinType pin_type, int* file_descriptor);
+
+/*
+ * Name: get_gpio_events
+ * Description: Reads and clears the event detect status registers (GPEDS0 and GPEDS1), so every event detected by 
+ *              the registers since the last call is collected at once.
+ * Note: Must be called after initialize_gpio. Events reported through kernel event files do not appear here.
+ * Parameters:
+ *       pin_events[out] - The pins with a pending event (Broadcom numbering).
+ * Returns: Result of the operation.
+ */
+StatusCode get_gpio_events(PinMask* pin_events);
+
+#endif /* EDGE_H_ */
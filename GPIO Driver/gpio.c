@@ -28,22 +28,36 @@
  * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
+// The BCM2711 peripherals are above 2 GB, so /dev/mem offsets need 64 bits on 32-bit systems
+#define _FILE_OFFSET_BITS 64
+
 #include "gpio.h"
 #include "register.h"
+#include "internal.h"
+#include "instrument.h"
 
 #include <unistd.h>
 #include <fcntl.h>
-#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
 #include <sys/mman.h>
 #include <sys/types.h>
 #include <stdbool.h>
+#include <time.h>
 
 /*
  * Global Variables
  */
 volatile Register_Type* gpio_memory = 0x00; // Memory address of mapped GPIO memory
+size_t gpio_memory_size = 0x00; // Size of the mapped GPIO memory
+volatile Register_Type* peripheral_memory[PERIPHERAL_REGION_COUNT]; // Mapped peripheral register blocks
+BackendType backend = MEMORY_BACKEND; // Where the GPIO memory is mapped from
 int revision = 0x00; // CPU Revision of the current Raspberry Pi
+uint32_t peripheral_base = 0x00; // Physical address of the peripherals of the current Raspberry Pi
+atomic_uint function_shadow[GPFSEL_REGISTER_COUNT]; // Copy of the function select registers
+atomic_uint register_locks[GPIO_MEMORY_SIZE / sizeof(Register_Type)]; // One lock per GPIO register
+pthread_mutex_t initialization_lock = PTHREAD_MUTEX_INITIALIZER; // Serializes initialization and finalization
 
 /*
  * Physical Pin Tables
@@ -51,10 +65,52 @@ int revision = 0x00; // CPU Revision of the current Raspberry Pi
  * These tables map physical pin numbers for each supported revision to the actual pin
  * numbers used internally by Broadcom.
  */
-const PhysicalPin REVISION_1_TABLE[] = {{3, 0}, {5, 1}, {7, 4}, {8, 14}, {10, 15}, {11, 17}, {12, 18},
-        {13, 21}, {15, 22}, {16, 23}, {18, 24}, {19, 10}, {21, 9}, {22, 25}, {23, 11}, {24, 8}, {26, 7}};
-const PhysicalPin REVISION_2_TABLE[] = {{3, 2}, {5, 3}, {7, 4}, {8, 14}, {10, 15}, {11, 17}, {12, 18},
-        {13, 27}, {15, 22}, {16, 23}, {18, 24}, {19, 10}, {21, 9}, {22, 25}, {23, 11}, {24, 8}, {26, 7}};
+const PhysicalPin REVISION_1_TABLE[] = REVISION_1_PINS;
+const PhysicalPin REVISION_2_TABLE[] = REVISION_2_PINS;
+const PhysicalPin REVISION_3_TABLE[] = REVISION_3_PINS;
+
+/*
+ * Name: PinTable
+ * Description: A physical pin table and its length.
+ */
+typedef struct {
+    const PhysicalPin* pins;
+    int pin_count;
+} PinTable;
+
+// Pin tables indexed by revision (the 40 pin header of every later board is revision 3)
+const PinTable PIN_TABLES[] = {{0x00, 0}, 
+        {REVISION_1_TABLE, sizeof(REVISION_1_TABLE) / sizeof(PhysicalPin)}, 
+        {REVISION_2_TABLE, sizeof(REVISION_2_TABLE) / sizeof(PhysicalPin)}, 
+        {REVISION_3_TABLE, sizeof(REVISION_3_TABLE) / sizeof(PhysicalPin)}};
+
+/*
+ * Name: PeripheralBlock
+ * Description: Location of a peripheral register block on the BCM2835 and in the simulated register file.
+ */
+typedef struct {
+    unsigned int memory_start;
+    size_t memory_size;
+    bool simulated; // false for blocks that plain memory cannot stand in for
+    size_t simulation_offset;
+} PeripheralBlock;
+
+// Peripheral register blocks indexed by PeripheralRegion
+const PeripheralBlock PERIPHERAL_BLOCKS[PERIPHERAL_REGION_COUNT] = {
+        {PWM_MEMORY_START, PWM_MEMORY_SIZE, true, offsetof(SimulatedGpio, pwm_registers)}, 
+        {CM_MEMORY_START, CM_MEMORY_SIZE, true, offsetof(SimulatedGpio, clock_registers)}, 
+        {DMA_MEMORY_START, DMA_MEMORY_SIZE, true, offsetof(SimulatedGpio, dma_registers)}, 
+        {TIMER_MEMORY_START, TIMER_MEMORY_SIZE, false, 0}};
+
+/*
+ * P1 Level Table
+ *
+ * The level table remaps a snapshot of the level registers into P1 connector order one byte at a
+ * time. Entry [n][value] holds the P1 pins that are high when byte n of the Broadcom levels equals
+ * value. The table is built for the current revision by initialize_gpio.
+ */
+PinMask p1_level_table[GPIO_PIN_COUNT / 8 + 1][256];
+PinMask p1_pin_mask = 0x00; // Every P1 pin that maps to a Broadcom pin on the current revision
 
 /*
  * Implementation Functions
@@ -62,6 +118,64 @@ const PhysicalPin REVISION_2_TABLE[] = {{3, 2}, {5, 3}, {7, 4}, {8, 14}, {10, 15
  * These functions are for internal use only.
  */
 
+/*
+ * Name: set_pin
+ * Description: Sets a GPIO pin (the body of set_gpio_pin).
+ * Parameters: See set_gpio_pin in gpio.h.
+ * Returns: Result of the operation.
+ */
+static StatusCode set_pin(int pin_number, PinType pin_type);
+
+/*
+ * Name: clear_pin
+ * Description: Clears a GPIO pin (the body of clear_gpio_pin).
+ * Parameters: See clear_gpio_pin in gpio.h.
+ * Returns: Result of the operation.
+ */
+static StatusCode clear_pin(int pin_number, PinType pin_type);
+
+/*
+ * Name: get_pin
+ * Description: Gets the value of a GPIO pin (the body of get_gpio_pin).
+ * Parameters: See get_gpio_pin in gpio.h.
+ * Returns: Result of the operation.
+ */
+static StatusCode get_pin(int pin_number, PinType pin_type, int* pin_value);
+
+/*
+ * Name: set_pin_mode
+ * Description: Sets the function of a GPIO pin (the body of set_gpio_pin_mode).
+ * Parameters: See set_gpio_pin_mode in gpio.h.
+ * Returns: Result of the operation.
+ */
+static StatusCode set_pin_mode(int pin_number, PinType pin_type, PinMode pin_mode);
+
+/*
+ * Name: get_levels
+ * Description: Reads the levels of the pins in a mask (the body of get_gpio_levels).
+ * Parameters: See get_gpio_levels in gpio.h.
+ * Returns: Result of the operation.
+ */
+static StatusCode get_levels(PinMask pin_mask, PinType pin_type, PinMask* pin_values);
+
+/*
+ * Name: write_mask
+ * Description: Drives the pins in a mask (the body of write_gpio_mask).
+ * Parameters: See write_gpio_mask in gpio.h.
+ * Returns: Result of the operation.
+ */
+static StatusCode write_mask(PinMask pin_mask, PinMask pin_values, PinType pin_type);
+
+/*
+ * Name: initialize_backend
+ * Description: Initializes the library from a backend. Called by initialize_gpio_backend with the initialization 
+ *              lock held.
+ * Parameters:
+ *       backend_type[in] - The backend used to access the GPIO registers.
+ * Returns: Result of the operation.
+ */
+static StatusCode initialize_backend(BackendType backend_type);
+
 /*
  * Name: map_memory
  * Description: Maps the GPIO register memory.
@@ -70,6 +184,43 @@ const PhysicalPin REVISION_2_TABLE[] = {{3, 2}, {5, 3}, {7, 4}, {8, 14}, {10, 15
  */
 static bool map_memory();
 
+/*
+ * Name: map_device
+ * Description: Maps the GPIO register memory from a device file.
+ * Parameters:
+ *       device_file[in] - Path of the device file to map.
+ *       offset[in] - Offset of the GPIO registers in the device file.
+ * Returns: true if memory is mapped successfully, otherwise false.
+ */
+static bool map_device(const char* device_file, off_t offset);
+
+/*
+ * Name: map_simulation
+ * Description: Maps a simulated GPIO register file from anonymous memory or from the file named by the 
+ *              simulation file environment variable.
+ * Parameters: None
+ * Returns: true if memory is mapped successfully, otherwise false.
+ */
+static bool map_simulation();
+
+/*
+ * Name: map_peripherals
+ * Description: Maps the peripheral register blocks that the backend provides. A block that cannot be mapped is left 
+ *              unmapped, and the functions that need it return UNSUPPORTED (or fall back to a system call, for the 
+ *              system timer).
+ * Parameters: None
+ * Returns: None
+ */
+static void map_peripherals();
+
+/*
+ * Name: unmap_peripherals
+ * Description: Unmaps the peripheral register blocks.
+ * Parameters: None
+ * Returns: None
+ */
+static void unmap_peripherals();
+
 /*
  * Name: unmap_memory
  * Description: Unmaps the GPIO register memory.
@@ -88,33 +239,19 @@ static bool check_root();
 
 /*
  * Name: set_cpu
- * Description: Sets the revision of the CPU used on this Raspberry Pi.
+ * Description: Sets the revision and peripheral base of the Raspberry Pi from the hardware probe.
  * Parameters: None
  * Returns: true if the CPU revision is recognized and set, otherwise false.
  */
 static bool set_cpu();
 
 /*
- * Name: check_init
- * Description: Checks that the memory has been mapped and the CPU revision has 
- *              been set.
+ * Name: load_level_table
+ * Description: Builds the P1 level table for the current revision.
  * Parameters: None
- * Returns: true if memory is mapped and CPU revision is set, otherwise false.
- */
-static bool check_init();
-
-/*
- * Name: pin_to_broadcom
- * Description: Retrieves the Broadcom pin number based on the chosen numbering
- *              convention.
- * Parameters:
- *       pin_number[in] - The GPIO member to retrieve a value from.
- *       pin_type[in] - The numbering convention used to identify the GPIO pin.
- *       broadcom_number[out] - The Broadcom pin number of the supplied pin.
- * Returns: true if a match was found between the pin number and Broadcom number, 
- *          otherwise false.
+ * Returns: None
  */
-static bool pin_to_broadcom(int pin_number, PinType pin_type, int* broadcom_number);
+static void load_level_table();
 
 /*
  * Name: pin_to_broadcom
@@ -138,49 +275,137 @@ static bool check_broadcom_pin(int broadcom_number);
 static bool check_physical_pin(int physical_number, PinType connector_type, int* broadcom_number);
 
 /*
- * Name: set_gpio_pin_function
- * Description: Converts a physical pin number to a Broadcom pin number.
+ * Name: set_broadcom_pulls
+ * Description: Sets the pull resistors of Broadcom pins grouped by pull mode. On the BCM2835 to BCM2837 each 
+ *              non-empty group costs one GPPUD/GPPUDCLK sequence. On the BCM2711 each control register that holds a 
+ *              selected pin gets one read-modify-write.
  * Parameters:
- *       physical_number[in] - The Broadcom pin to set the register function of.
- *       function_code[in] - The register function number.
- * Returns: true if register function is changed successfully, otherwise false.
+ *       pull_masks[in] - The Broadcom pins to give each PullMode, indexed by PullMode.
+ * Returns: None
+ */
+static void set_broadcom_pulls(const PinMask pull_masks[PULL_MODE_COUNT]);
+
+/*
+ * Name: wait_pull_setup
+ * Description: Busy-waits for the GPPUD setup and hold time.
+ * Parameters: None
+ * Returns: None
+ */
+static void wait_pull_setup();
+
+/*
+ * Name: load_function_shadow
+ * Description: Copies the function select registers into the shadow copy used to skip redundant writes.
+ * Parameters: None
+ * Returns: None
  */
-static bool set_gpio_pin_function(int broadcom_number, int function_code);
+static void load_function_shadow();
 
 StatusCode initialize_gpio()
 {
-    // Root permissions are necessary to map memory
-    if(!check_root())
+    return initialize_gpio_backend(MEMORY_BACKEND);
+}
+
+StatusCode initialize_gpio_backend(BackendType backend_type)
+{
+    StatusCode status;
+
+    pthread_mutex_lock(&initialization_lock);
+    status = initialize_backend(backend_type);
+    pthread_mutex_unlock(&initialization_lock);
+
+    return status;
+}
+
+static StatusCode initialize_backend(BackendType backend_type)
+{
+    // Initializing again replaces the earlier initialization, so its mappings are released first (while backend 
+    // still tells how they were made)
+    if(gpio_memory != 0x00)
     {
-        return NOT_ROOT;
+        close_edge_files();
+        unmap_memory();
+        revision = 0x00;
+        peripheral_base = 0x00;
     }
 
-    // If the chipset is not recognized, the GPIO memory region cannot be mapped
-    if(!set_cpu())
+    backend = backend_type;
+
+    if(backend == SIMULATED_BACKEND)
+    {
+        // The simulation does not need root or a Raspberry Pi
+        revision = SIMULATED_REVISION;
+        peripheral_base = BCM2835_PERIPHERAL_BASE;
+    }
+    else
     {
-        return INVALID_CHIPSET;
+        // Root permissions are necessary to map /dev/mem
+        if(backend == MEMORY_BACKEND && !check_root())
+        {
+            return NOT_ROOT;
+        }
+
+        // If the chipset is not recognized, the GPIO memory region cannot be mapped
+        if(!set_cpu())
+        {
+            return INVALID_CHIPSET;
+        }
     }
 
+    load_level_table();
+
     // GPIO is initialized once the memory is mapped successfully
     if(map_memory())
     {
+        map_peripherals();
+        load_function_shadow();
         return SUCCESS;
     }
     else
     {
+        revision = 0x00;
         return CANNOT_MAP_MEMORY;
     }
 }
 
 StatusCode finalize_gpio()
 {
+    pthread_mutex_lock(&initialization_lock);
+    close_edge_files();
     unmap_memory();
     revision = 0x00;
+    peripheral_base = 0x00;
+    pthread_mutex_unlock(&initialization_lock);
 
     return SUCCESS;
 }
 
+int get_gpio_revision()
+{
+    return check_init() ? revision : 0x00;
+}
+
+volatile unsigned int* get_gpio_registers()
+{
+    return check_init() ? gpio_memory : 0x00;
+}
+
+volatile unsigned int* get_gpio_peripheral_registers(PeripheralRegion region)
+{
+    if(!check_init() || region < 0 || region >= PERIPHERAL_REGION_COUNT)
+    {
+        return 0x00;
+    }
+
+    return peripheral_memory[region];
+}
+
 StatusCode set_gpio_pin(int pin_number, PinType pin_type)
+{
+    INSTRUMENTED(INSTRUMENT_SET_PIN, pin_number, pin_type, set_pin(pin_number, pin_type));
+}
+
+static StatusCode set_pin(int pin_number, PinType pin_type)
 {
     bool status;
     int set_register;
@@ -232,6 +457,11 @@ StatusCode set_gpio_pin(int pin_number, PinType pin_type)
 }
 
 StatusCode clear_gpio_pin(int pin_number, PinType pin_type)
+{
+    INSTRUMENTED(INSTRUMENT_CLEAR_PIN, pin_number, pin_type, clear_pin(pin_number, pin_type));
+}
+
+static StatusCode clear_pin(int pin_number, PinType pin_type)
 {
     bool status;
     int clear_register;
@@ -284,6 +514,11 @@ StatusCode clear_gpio_pin(int pin_number, PinType pin_type)
 }
 
 StatusCode get_gpio_pin(int pin_number, PinType pin_type, int* pin_value)
+{
+    INSTRUMENTED(INSTRUMENT_GET_PIN, pin_number, pin_type, get_pin(pin_number, pin_type, pin_value));
+}
+
+static StatusCode get_pin(int pin_number, PinType pin_type, int* pin_value)
 {
     bool status;
     int status_register;
@@ -304,12 +539,15 @@ StatusCode get_gpio_pin(int pin_number, PinType pin_type, int* pin_value)
         return INVALID_PIN;
     }
 
-    // Set the pin function to input mode
-    status = set_gpio_pin_function(broadcom_number, GPIO_INPUT);
-
-    if(!status)
+    // Outputs can be read back directly, anything else has to be switched to input mode
+    if(get_gpio_pin_function(broadcom_number) != GPIO_OUTPUT)
     {
-        return REGISTER_FAILURE;
+        status = set_gpio_pin_function(broadcom_number, GPIO_INPUT);
+
+        if(!status)
+        {
+            return REGISTER_FAILURE;
+        }
     }
 
     // Find the correct register
@@ -330,173 +568,625 @@ StatusCode get_gpio_pin(int pin_number, PinType pin_type, int* pin_value)
     bit_offset = (broadcom_number % (REGISTER_SIZE / GPLEV_BITS_PER_PIN)) * GPLEV_BITS_PER_PIN;
 
     // Get the pin value
-    *pin_value = *(gpio_memory + calculate_offset(status_register)) >> bit_offset;
+    *pin_value = (*(gpio_memory + calculate_offset(status_register)) >> bit_offset) & 0x01;
 
     return SUCCESS;
 }
 
-static bool map_memory()
+StatusCode set_gpio_pin_mode(int pin_number, PinType pin_type, PinMode pin_mode)
 {
-    int memory_file;
+    INSTRUMENTED(INSTRUMENT_SET_PIN_MODE, pin_number, pin_type, set_pin_mode(pin_number, pin_type, pin_mode));
+}
 
-    // Attempt to open the memory file
-    memory_file = open(MEMORY_FILE, O_RDWR);
+static StatusCode set_pin_mode(int pin_number, PinType pin_type, PinMode pin_mode)
+{
+    bool status;
+    int broadcom_number;
 
-    if(memory_file < 0)
+    // Check initialization
+    if(!check_init())
     {
-        return false;
+        return NO_INIT;
     }
 
-    // Attempt to map the memory
-    gpio_memory = mmap(0x00, GPIO_MEMORY_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, memory_file, GPIO_MEMORY_START);
-    close(memory_file);
+    // Attempt to get the Broadcom pin number
+    status = pin_to_broadcom(pin_number, pin_type, &broadcom_number);
 
-    if(gpio_memory == MAP_FAILED)
+    if(!status)
     {
-        gpio_memory = 0x00;
-        return false;
+        return INVALID_PIN;
     }
 
-    // Success once memory has been mapped
-    return true;
-}
+    // Change the pin function (skipped when the pin is already in the requested mode)
+    status = set_gpio_pin_function(broadcom_number, pin_mode);
 
-static void unmap_memory()
-{
-    if(gpio_memory != 0)
+    if(!status)
     {
-        munmap((void*) gpio_memory, GPIO_MEMORY_SIZE);
+        return REGISTER_FAILURE;
     }
+
+    return SUCCESS;
 }
 
-static bool check_root()
+StatusCode get_gpio_pin_mode(int pin_number, PinType pin_type, PinMode* pin_mode)
 {
-    if(geteuid() == 0)
+    bool status;
+    int broadcom_number;
+
+    // Check initialization
+    if(!check_init())
     {
-        return true;
+        return NO_INIT;
     }
-    else
+
+    // Attempt to get the Broadcom pin number
+    status = pin_to_broadcom(pin_number, pin_type, &broadcom_number);
+
+    if(!status)
     {
-        return false;
+        return INVALID_PIN;
     }
+
+    *pin_mode = (PinMode) get_gpio_pin_function(broadcom_number);
+
+    return SUCCESS;
 }
 
-static bool set_cpu()
+StatusCode set_gpio_mask_mode(PinMask pin_mask, PinType pin_type, PinMode pin_mode)
 {
-    FILE* cpu_info_file;
-    char cpu_info_stream[MAX_LINE_LENGTH];
-    char chipset[MAX_LINE_LENGTH];
-    int chipset_revision = -1;
-
-    cpu_info_file = fopen(CPU_INFO_PATH, "r");
+    bool status;
+    PinMask broadcom_mask;
+    PinMask broadcom_values;
 
-    if(!cpu_info_file)
+    // Check initialization
+    if(!check_init())
     {
-        return false;
+        return NO_INIT;
     }
 
-    while(fgets(cpu_info_stream, MAX_LINE_LENGTH, cpu_info_file))
+    // Attempt to convert the mask to Broadcom pin numbers
+    status = mask_to_broadcom(pin_mask, 0x00, pin_type, &broadcom_mask, &broadcom_values);
+
+    if(!status)
     {
-        sscanf(cpu_info_stream, CHIPSET_HEADER "%s", chipset);
-        sscanf(cpu_info_stream, REVISION_HEADER "%x", &chipset_revision);
+        return INVALID_PIN;
     }
 
-    // Overvolted Raspberry Pi's are prefixed with 1000. Ignore it.
-    chipset_revision %= REVISION_LENGTH;
+    // Change the pin functions (registers that are already correct are skipped)
+    status = set_gpio_mask_function(broadcom_mask, pin_mode);
 
-    // Check chipset
-    if(strcmp(CHIPSET, chipset) != 0)
+    if(!status)
     {
-        return false;
+        return REGISTER_FAILURE;
     }
 
-    // Check revision
-    if(chipset_revision >= REVISION_1_START && chipset_revision < REVISION_2_START)
+    return SUCCESS;
+}
+
+StatusCode set_gpio_pin_pull(int pin_number, PinType pin_type, PullMode pull_mode)
+{
+    PinPull pin_pull = {pin_number, pull_mode};
+
+    return set_gpio_pulls(&pin_pull, 1, pin_type);
+}
+
+StatusCode set_gpio_mask_pull(PinMask pin_mask, PinType pin_type, PullMode pull_mode)
+{
+    bool status;
+    PinMask pull_masks[PULL_MODE_COUNT] = {0x00, 0x00, 0x00};
+    PinMask broadcom_values;
+
+    // Check initialization
+    if(!check_init())
     {
-        revision = 1;
+        return NO_INIT;
     }
-    else if(chipset_revision >= REVISION_2_START)
+
+    if(pull_mode < PULL_OFF || pull_mode > PULL_UP)
     {
-        revision = 2;
+        return REGISTER_FAILURE;
     }
-    else
+
+    // Attempt to convert the mask to Broadcom pin numbers
+    status = mask_to_broadcom(pin_mask, 0x00, pin_type, &pull_masks[pull_mode], &broadcom_values);
+
+    if(!status)
     {
-        return false;
+        return INVALID_PIN;
     }
 
-    return true;
+    set_broadcom_pulls(pull_masks);
+
+    return SUCCESS;
 }
 
-static bool check_init()
+StatusCode set_gpio_pulls(const PinPull* pin_pulls, int pull_count, PinType pin_type)
 {
-    if(gpio_memory == 0x00)
+    bool status;
+    PinMask pull_masks[PULL_MODE_COUNT] = {0x00, 0x00, 0x00};
+    PinMask pin_bit;
+    int broadcom_number;
+    int mode;
+    int i;
+
+    // Check initialization
+    if(!check_init())
     {
-        return false;
+        return NO_INIT;
     }
 
-    if(revision == 0x00)
+    // Check every pin before changing anything, grouping the pins by pull mode
+    for(i = 0; i < pull_count; i++)
     {
-        return false;
-    }
+        status = pin_to_broadcom(pin_pulls[i].pin_number, pin_type, &broadcom_number);
 
-    return true;
-}
+        if(!status)
+        {
+            return INVALID_PIN;
+        }
 
-static bool pin_to_broadcom(int pin_number, PinType pin_type, int* broadcom_number)
-{
-    bool result;
+        if(pin_pulls[i].pull_mode < PULL_OFF || pin_pulls[i].pull_mode > PULL_UP)
+        {
+            return REGISTER_FAILURE;
+        }
 
-    // Any pin type other than Broadcom needs to be checked as a physical pin
-    if(pin_type != BROADCOM)
-    {
-        result = check_physical_pin(pin_number, pin_type, broadcom_number);
+        pin_bit = (PinMask) 1 << broadcom_number;
 
-        if(!result)
+        for(mode = 0; mode < PULL_MODE_COUNT; mode++)
         {
-            return false;
+            pull_masks[mode] &= ~pin_bit;
         }
+
+        pull_masks[pin_pulls[i].pull_mode] |= pin_bit;
     }
 
-    // Verify Broadcom number (or physical pin converted into a Broadcom)
-    result = check_broadcom_pin(*broadcom_number);
+    set_broadcom_pulls(pull_masks);
 
-    return result;
+    return SUCCESS;
 }
 
-static bool check_broadcom_pin(int broadcom_number)
+StatusCode open_gpio_handle(int pin_number, PinType pin_type, PinMode pin_mode, PinHandle* pin_handle)
 {
-    if(broadcom_number <= GPIO_PIN_COUNT && broadcom_number >= 0)
+    bool status;
+    int bank;
+    int broadcom_number;
+
+    // Check initialization
+    if(!check_init())
     {
-        return true;
+        return NO_INIT;
     }
 
-    return false;
-}
-
-static bool check_physical_pin(int physical_pin_number, PinType connector_type, int* broadcom_number)
-{
-	int table_size;
-    const PhysicalPin* pin_table;
-    int i;
+    // Attempt to get the Broadcom pin number
+    status = pin_to_broadcom(pin_number, pin_type, &broadcom_number);
 
-    // Get the correct pin table based on the connector and revision
-    if(connector_type == P1CONNECTOR)
+    if(!status)
     {
-        if(revision == 1)
-        {
-            pin_table = REVISION_1_TABLE;
-            table_size = sizeof(REVISION_1_TABLE) / sizeof(PhysicalPin);
-        }
-        else if(revision == 2)
-        {
-            pin_table = REVISION_2_TABLE;
-            table_size = sizeof(REVISION_2_TABLE) / sizeof(PhysicalPin);
+        return INVALID_PIN;
+    }
+
+    // Set the pin function once, so the handle functions never have to
+    status = set_gpio_pin_function(broadcom_number, pin_mode);
+
+    if(!status)
+    {
+        return REGISTER_FAILURE;
+    }
+
+    // Resolve the registers of the bank holding the pin (GPSET, GPCLR, and GPLEV banks are laid out alike)
+    bank = broadcom_number / REGISTER_SIZE;
+
+    pin_handle->set_register = gpio_memory + calculate_offset(GPSET0) + bank;
+    pin_handle->clear_register = gpio_memory + calculate_offset(GPCLR0) + bank;
+    pin_handle->level_register = gpio_memory + calculate_offset(GPLEV0) + bank;
+    pin_handle->bit_mask = 0x01 << (broadcom_number % REGISTER_SIZE);
+    pin_handle->broadcom_number = broadcom_number;
+
+    return SUCCESS;
+}
+
+StatusCode get_gpio_levels(PinMask pin_mask, PinType pin_type, PinMask* pin_values)
+{
+    INSTRUMENTED(INSTRUMENT_GET_LEVELS, INSTRUMENT_NO_PIN, pin_type, get_levels(pin_mask, pin_type, pin_values));
+}
+
+static StatusCode get_levels(PinMask pin_mask, PinType pin_type, PinMask* pin_values)
+{
+    PinMask levels;
+    unsigned int byte;
+
+    // Check initialization
+    if(!check_init())
+    {
+        return NO_INIT;
+    }
+
+    // Take the snapshot first, so both banks are read as close together as possible
+    levels = *(gpio_memory + calculate_offset(GPLEV0));
+    levels |= (PinMask) *(gpio_memory + calculate_offset(GPLEV1)) << REGISTER_SIZE;
+
+    if(pin_type == BROADCOM)
+    {
+        if((pin_mask >> (GPIO_PIN_COUNT + 1)) != 0)
+        {
+            return INVALID_PIN;
+        }
+
+        *pin_values = levels & pin_mask;
+
+        return SUCCESS;
+    }
+
+    if((pin_mask & ~p1_pin_mask) != 0)
+    {
+        return INVALID_PIN;
+    }
+
+    // Remap the snapshot into P1 connector order one byte at a time
+    *pin_values = 0x00;
+
+    for(byte = 0; byte < sizeof(p1_level_table) / sizeof(p1_level_table[0]); byte++)
+    {
+        *pin_values |= p1_level_table[byte][(levels >> (byte * 8)) & 0xFF];
+    }
+
+    *pin_values &= pin_mask;
+
+    return SUCCESS;
+}
+
+StatusCode write_gpio_mask(PinMask pin_mask, PinMask pin_values, PinType pin_type)
+{
+    INSTRUMENTED(INSTRUMENT_WRITE_MASK, INSTRUMENT_NO_PIN, pin_type, write_mask(pin_mask, pin_values, pin_type));
+}
+
+static StatusCode write_mask(PinMask pin_mask, PinMask pin_values, PinType pin_type)
+{
+    bool status;
+    PinMask broadcom_mask;
+    PinMask broadcom_values;
+    PinMask set_bits;
+    PinMask clear_bits;
+
+    // Check initialization
+    if(!check_init())
+    {
+        return NO_INIT;
+    }
+
+    // Attempt to convert the mask to Broadcom pin numbers
+    status = mask_to_broadcom(pin_mask, pin_values, pin_type, &broadcom_mask, &broadcom_values);
+
+    if(!status)
+    {
+        return INVALID_PIN;
+    }
+
+    // Set the pin functions to output mode
+    status = set_gpio_mask_function(broadcom_mask, GPIO_OUTPUT);
+
+    if(!status)
+    {
+        return REGISTER_FAILURE;
+    }
+
+    set_bits = broadcom_mask & broadcom_values;
+    clear_bits = broadcom_mask & ~broadcom_values;
+
+    /* Each bank is written with a single store, so all of the pins in a bank change at the same 
+       time. Banks without any pins to change are not written at all. */
+    if((set_bits & 0xFFFFFFFF) != 0)
+    {
+        *(gpio_memory + calculate_offset(GPSET0)) = (unsigned int) set_bits;
+    }
+
+    if((set_bits >> REGISTER_SIZE) != 0)
+    {
+        *(gpio_memory + calculate_offset(GPSET1)) = (unsigned int) (set_bits >> REGISTER_SIZE);
+    }
+
+    if((clear_bits & 0xFFFFFFFF) != 0)
+    {
+        *(gpio_memory + calculate_offset(GPCLR0)) = (unsigned int) clear_bits;
+    }
+
+    if((clear_bits >> REGISTER_SIZE) != 0)
+    {
+        *(gpio_memory + calculate_offset(GPCLR1)) = (unsigned int) (clear_bits >> REGISTER_SIZE);
+    }
+
+    return SUCCESS;
+}
+
+StatusCode set_gpio_mask(PinMask pin_mask, PinType pin_type)
+{
+    return write_gpio_mask(pin_mask, pin_mask, pin_type);
+}
+
+StatusCode clear_gpio_mask(PinMask pin_mask, PinType pin_type)
+{
+    return write_gpio_mask(pin_mask, 0x00, pin_type);
+}
+
+static bool map_memory()
+{
+    switch(backend)
+    {
+    case MEMORY_BACKEND:
+        return map_device(MEMORY_FILE, peripheral_base + GPIO_PERIPHERAL_OFFSET);
+    case GPIOMEM_BACKEND:
+        // /dev/gpiomem starts at the GPIO registers
+        return map_device(GPIOMEM_FILE, 0x00);
+    case SIMULATED_BACKEND:
+        return map_simulation();
+    default:
+        return false;
+    }
+}
+
+static bool map_device(const char* device_file, off_t offset)
+{
+    int memory_file;
+
+    // Attempt to open the memory file
+    memory_file = open(device_file, O_RDWR);
+
+    if(memory_file < 0)
+    {
+        return false;
+    }
+
+    // Attempt to map the memory
+    gpio_memory = mmap(0x00, GPIO_MEMORY_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, memory_file, offset);
+    close(memory_file);
+
+    if(gpio_memory == MAP_FAILED)
+    {
+        gpio_memory = 0x00;
+        return false;
+    }
+
+    // Success once memory has been mapped
+    gpio_memory_size = GPIO_MEMORY_SIZE;
+
+    return true;
+}
+
+static bool map_simulation()
+{
+    const char* simulation_file_name;
+    int simulation_file;
+
+    simulation_file_name = getenv(SIMULATION_FILE_VARIABLE);
+
+    if(simulation_file_name == 0x00)
+    {
+        // Without a file, the simulation lives in anonymous memory private to this process (and its children)
+        gpio_memory = mmap(0x00, sizeof(SimulatedGpio), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    }
+    else
+    {
+        // With a file, every process that maps the same file shares the same simulated registers
+        simulation_file = open(simulation_file_name, O_RDWR | O_CREAT, SIMULATION_FILE_MODE);
+
+        if(simulation_file < 0)
+        {
+            return false;
+        }
+
+        if(ftruncate(simulation_file, sizeof(SimulatedGpio)) != 0)
+        {
+            close(simulation_file);
+            return false;
+        }
+
+        gpio_memory = mmap(0x00, sizeof(SimulatedGpio), PROT_READ | PROT_WRITE, MAP_SHARED, simulation_file, 0);
+        close(simulation_file);
+    }
+
+    if(gpio_memory == MAP_FAILED)
+    {
+        gpio_memory = 0x00;
+        return false;
+    }
+
+    gpio_memory_size = sizeof(SimulatedGpio);
+
+    return true;
+}
+
+static void map_peripherals()
+{
+    int memory_file;
+    int region;
+    void* memory;
+
+    switch(backend)
+    {
+    case MEMORY_BACKEND:
+        memory_file = open(MEMORY_FILE, O_RDWR);
+
+        if(memory_file < 0)
+        {
+            return;
+        }
+
+        // The blocks are at the same offsets from the peripheral base on every chip
+        for(region = 0; region < PERIPHERAL_REGION_COUNT; region++)
+        {
+            memory = mmap(0x00, PERIPHERAL_BLOCKS[region].memory_size, PROT_READ | PROT_WRITE, MAP_SHARED, 
+                    memory_file, (off_t) peripheral_base + 
+                    (PERIPHERAL_BLOCKS[region].memory_start - BCM2835_PERIPHERAL_BASE));
+            peripheral_memory[region] = memory == MAP_FAILED ? 0x00 : memory;
+        }
+
+        close(memory_file);
+        break;
+    case SIMULATED_BACKEND:
+        // The simulated blocks follow the simulated GPIO registers in the same register file
+        for(region = 0; region < PERIPHERAL_REGION_COUNT; region++)
+        {
+            if(PERIPHERAL_BLOCKS[region].simulated)
+            {
+                peripheral_memory[region] = (volatile Register_Type*) 
+                        ((volatile char*) gpio_memory + PERIPHERAL_BLOCKS[region].simulation_offset);
+            }
+        }
+
+        break;
+    default:
+        // /dev/gpiomem only exposes the GPIO registers
+        break;
+    }
+}
+
+static void unmap_peripherals()
+{
+    int region;
+
+    for(region = 0; region < PERIPHERAL_REGION_COUNT; region++)
+    {
+        if(peripheral_memory[region] != 0 && backend == MEMORY_BACKEND)
+        {
+            munmap((void*) peripheral_memory[region], PERIPHERAL_BLOCKS[region].memory_size);
+        }
+
+        peripheral_memory[region] = 0x00;
+    }
+}
+
+static void unmap_memory()
+{
+    unmap_peripherals();
+
+    if(gpio_memory != 0)
+    {
+        munmap((void*) gpio_memory, gpio_memory_size);
+        gpio_memory = 0x00;
+        gpio_memory_size = 0x00;
+    }
+}
+
+static bool check_root()
+{
+    if(geteuid() == 0)
+    {
+        return true;
+    }
+    else
+    {
+        return false;
+    }
+}
+
+static bool set_cpu()
+{
+    BoardInfo board_info;
+
+    if(!probe_board(&board_info))
+    {
+        return false;
+    }
+
+    revision = board_info.revision;
+    peripheral_base = board_info.peripheral_base;
+
+    return true;
+}
+
+static void load_level_table()
+{
+    int physical_number;
+    int broadcom_number;
+    int value;
+
+    memset(p1_level_table, 0x00, sizeof(p1_level_table));
+    p1_pin_mask = 0x00;
+
+    for(physical_number = 0; physical_number < (int) (sizeof(PinMask) * 8); physical_number++)
+    {
+        if(!check_physical_pin(physical_number, P1CONNECTOR, &broadcom_number))
+        {
+            continue;
         }
-        else
+
+        p1_pin_mask |= (PinMask) 1 << physical_number;
+
+        // Every byte value with the Broadcom pin's bit set turns on the P1 pin's bit
+        for(value = 0; value < 256; value++)
+        {
+            if((value & (0x01 << (broadcom_number % 8))) != 0)
+            {
+                p1_level_table[broadcom_number / 8][value] |= (PinMask) 1 << physical_number;
+            }
+        }
+    }
+}
+
+bool check_init()
+{
+    if(gpio_memory == 0x00)
+    {
+        return false;
+    }
+
+    if(revision == 0x00)
+    {
+        return false;
+    }
+
+    return true;
+}
+
+bool pin_to_broadcom(int pin_number, PinType pin_type, int* broadcom_number)
+{
+    bool result;
+
+    // Any pin type other than Broadcom needs to be checked as a physical pin
+    if(pin_type != BROADCOM)
+    {
+        result = check_physical_pin(pin_number, pin_type, broadcom_number);
+
+        if(!result)
         {
             return false;
         }
     }
+    else
+    {
+        *broadcom_number = pin_number;
+    }
+
+    // Verify Broadcom number (or physical pin converted into a Broadcom)
+    result = check_broadcom_pin(*broadcom_number);
+
+    return result;
+}
+
+static bool check_broadcom_pin(int broadcom_number)
+{
+    if(broadcom_number <= GPIO_PIN_COUNT && broadcom_number >= 0)
+    {
+        return true;
+    }
+
+    return false;
+}
+
+static bool check_physical_pin(int physical_pin_number, PinType connector_type, int* broadcom_number)
+{
+	int table_size;
+    const PhysicalPin* pin_table;
+    int i;
+
+    // Get the correct pin table based on the connector and revision
+    if(connector_type != P1CONNECTOR || revision <= 0 || revision >= (int) (sizeof(PIN_TABLES) / sizeof(PinTable)))
+    {
+        return false;
+    }
+
+    pin_table = PIN_TABLES[revision].pins;
+    table_size = PIN_TABLES[revision].pin_count;
 
     /* Check the pin mapping tables to find the Broadcom GPIO pin number based on the 
 	   type of numbering convention the user chose and the Raspberry Pi's revision.
@@ -519,49 +1209,251 @@ static bool check_physical_pin(int physical_pin_number, PinType connector_type,
     return false;
 }
 
-static bool set_gpio_pin_function(int broadcom_number, int function_code)
+static void set_broadcom_pulls(const PinMask pull_masks[PULL_MODE_COUNT])
 {
-    int function_register;
+    static const unsigned int BCM2711_PULL_CODES[PULL_MODE_COUNT] = {GPIO_PUP_PDN_NONE, GPIO_PUP_PDN_DOWN, 
+            GPIO_PUP_PDN_UP};
+    int pins_per_register = REGISTER_SIZE / GPIO_PUP_PDN_BITS_PER_PIN;
+    unsigned int control_address;
+    unsigned int clear_bits;
+    unsigned int set_bits;
     int bit_offset;
+    int broadcom_number;
+    int register_number;
+    int mode;
+
+    if(peripheral_base == BCM2711_PERIPHERAL_BASE)
+    {
+        // The BCM2711 holds the pull state of each pin in a control register, so there is no sequence to run
+        for(register_number = 0; register_number * pins_per_register <= GPIO_PIN_COUNT; register_number++)
+        {
+            clear_bits = 0x00;
+            set_bits = 0x00;
+
+            for(mode = 0; mode < PULL_MODE_COUNT; mode++)
+            {
+                for(broadcom_number = register_number * pins_per_register; 
+                    broadcom_number < (register_number + 1) * pins_per_register; broadcom_number++)
+                {
+                    if((pull_masks[mode] >> broadcom_number) & 0x01)
+                    {
+                        bit_offset = (broadcom_number % pins_per_register) * GPIO_PUP_PDN_BITS_PER_PIN;
+                        clear_bits |= GPIO_PUP_PDN_BITS << bit_offset;
+                        set_bits |= BCM2711_PULL_CODES[mode] << bit_offset;
+                    }
+                }
+            }
+
+            if(clear_bits == 0x00)
+            {
+                continue;
+            }
+
+            control_address = GPIO_PUP_PDN_CNTRL_REG0 + register_number * sizeof(Register_Type);
+
+            lock_register(control_address);
+            *(gpio_memory + calculate_offset(control_address)) = 
+                    (*(gpio_memory + calculate_offset(control_address)) & ~clear_bits) | set_bits;
+            unlock_register(control_address);
+        }
+
+        return;
+    }
+
+    // GPPUD and GPPUDCLK are shared by every pin, so the whole sequence runs under one lock
+    lock_register(GPPUD);
+
+    for(mode = 0; mode < PULL_MODE_COUNT; mode++)
+    {
+        if(pull_masks[mode] == 0x00)
+        {
+            continue;
+        }
+
+        // Set the control signal, clock it into every pin of the group, then remove the signal and the clock
+        *(gpio_memory + calculate_offset(GPPUD)) = mode;
+        wait_pull_setup();
+        *(gpio_memory + calculate_offset(GPPUDCLK0)) = (Register_Type) pull_masks[mode];
+        *(gpio_memory + calculate_offset(GPPUDCLK1)) = (Register_Type) (pull_masks[mode] >> REGISTER_SIZE);
+        wait_pull_setup();
+        *(gpio_memory + calculate_offset(GPPUD)) = PULL_OFF;
+        *(gpio_memory + calculate_offset(GPPUDCLK0)) = 0x00;
+        *(gpio_memory + calculate_offset(GPPUDCLK1)) = 0x00;
+    }
+
+    unlock_register(GPPUD);
+}
+
+static void wait_pull_setup()
+{
+    struct timespec start;
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    do
+    {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+    } while((now.tv_sec - start.tv_sec) * 1000000000L + (now.tv_nsec - start.tv_nsec) < PULL_SETUP_TIME);
+}
+
+static void load_function_shadow()
+{
+    int register_number;
+
+    for(register_number = 0; register_number < GPFSEL_REGISTER_COUNT; register_number++)
+    {
+        atomic_store_explicit(&function_shadow[register_number], 
+                *(gpio_memory + calculate_offset(GPFSEL0) + register_number), memory_order_relaxed);
+    }
+}
+
+int get_gpio_pin_function(int broadcom_number)
+{
+    int pins_per_register = REGISTER_SIZE / GPFSEL_BITS_PER_PIN;
+    int bit_offset = (broadcom_number % pins_per_register) * GPFSEL_BITS_PER_PIN;
+
+    return (atomic_load_explicit(&function_shadow[broadcom_number / pins_per_register], memory_order_relaxed) >> 
+            bit_offset) & GPFSEL_BITS;
+}
+
+bool set_gpio_pin_function(int broadcom_number, int function_code)
+{
+    int pins_per_register = REGISTER_SIZE / GPFSEL_BITS_PER_PIN;
+    int register_number;
+    int bit_offset;
+    volatile Register_Type* function_register;
 
     // Function code must be 0 to 7
-    if(function_code > 8 || function_code < 0)
+    if(function_code > 7 || function_code < 0)
     {
         return false;
     }
 
-    // Set the correct function select register
-    switch(broadcom_number / (REGISTER_SIZE / GPFSEL_BITS_PER_PIN))
+    register_number = broadcom_number / pins_per_register;
+
+    if(register_number < 0 || register_number >= GPFSEL_REGISTER_COUNT)
+    {
+        return false;
+    }
+
+    bit_offset = (broadcom_number % pins_per_register) * GPFSEL_BITS_PER_PIN;
+
+    // Nothing to write (or lock) if the pin already has the requested function
+    if(((atomic_load_explicit(&function_shadow[register_number], memory_order_relaxed) >> bit_offset) & GPFSEL_BITS) == 
+       (unsigned int) function_code)
+    {
+        return true;
+    }
+
+    /* Clear and set the bits with a single read-modify-write, then keep the shadow copy in step. Other 
+       pins share the register, so the read-modify-write is serialized with the register's lock. */
+    function_register = gpio_memory + calculate_offset(GPFSEL0) + register_number;
+
+    lock_register(GPFSEL0 + register_number * sizeof(Register_Type));
+    *function_register = (*function_register & ~(GPFSEL_BITS << bit_offset)) | (function_code << bit_offset);
+    atomic_store_explicit(&function_shadow[register_number], *function_register, memory_order_relaxed);
+    unlock_register(GPFSEL0 + register_number * sizeof(Register_Type));
+
+    return true;
+}
+
+bool mask_to_broadcom(PinMask pin_mask, PinMask pin_values, PinType pin_type, PinMask* broadcom_mask, 
+        PinMask* broadcom_values)
+{
+    int pin_number;
+    int broadcom_number;
+
+    // Broadcom masks only need to be checked for pins past the end of the GPIO block
+    if(pin_type == BROADCOM)
+    {
+        if((pin_mask >> (GPIO_PIN_COUNT + 1)) != 0)
+        {
+            return false;
+        }
+
+        *broadcom_mask = pin_mask;
+        *broadcom_values = pin_values & pin_mask;
+
+        return true;
+    }
+
+    *broadcom_mask = 0x00;
+    *broadcom_values = 0x00;
+
+    // Any other pin type is converted one selected pin at a time
+    for(pin_number = 0; pin_number < (int) (sizeof(PinMask) * 8); pin_number++)
+    {
+        if((pin_mask & ((PinMask) 1 << pin_number)) == 0)
+        {
+            continue;
+        }
+
+        if(!pin_to_broadcom(pin_number, pin_type, &broadcom_number))
+        {
+            return false;
+        }
+
+        *broadcom_mask |= (PinMask) 1 << broadcom_number;
+
+        if((pin_values & ((PinMask) 1 << pin_number)) != 0)
+        {
+            *broadcom_values |= (PinMask) 1 << broadcom_number;
+        }
+    }
+
+    return true;
+}
+
+bool set_gpio_mask_function(PinMask broadcom_mask, int function_code)
+{
+    int pins_per_register = REGISTER_SIZE / GPFSEL_BITS_PER_PIN;
+    int register_number;
+    int broadcom_number;
+    int bit_offset;
+    unsigned int clear_bits;
+    unsigned int set_bits;
+    volatile Register_Type* function_register;
+
+    // Function code must be 0 to 7
+    if(function_code > 7 || function_code < 0)
     {
-    case 0:
-        function_register = GPFSEL0;
-        break;
-    case 1:
-        function_register = GPFSEL1;
-        break;
-    case 2:
-        function_register = GPFSEL2;
-        break;
-    case 3:
-        function_register = GPFSEL3;
-        break;
-    case 4:
-        function_register = GPFSEL4;
-        break;
-    case 5:
-        function_register = GPFSEL5;
-        break;
-    default:
         return false;
     }
 
-    bit_offset = (broadcom_number % (REGISTER_SIZE / GPFSEL_BITS_PER_PIN)) * GPFSEL_BITS_PER_PIN;
+    // Collect the bits for each function select register, so each register is only written once
+    for(register_number = 0; register_number <= GPIO_PIN_COUNT / pins_per_register; register_number++)
+    {
+        clear_bits = 0x00;
+        set_bits = 0x00;
 
-    // The bits need to be cleared before they can be set again
-    *(gpio_memory + calculate_offset(function_register)) &= ~(0x07 << bit_offset);
+        for(broadcom_number = register_number * pins_per_register; 
+            broadcom_number < (register_number + 1) * pins_per_register && broadcom_number <= GPIO_PIN_COUNT; 
+            broadcom_number++)
+        {
+            if((broadcom_mask & ((PinMask) 1 << broadcom_number)) == 0)
+            {
+                continue;
+            }
+
+            bit_offset = (broadcom_number % pins_per_register) * GPFSEL_BITS_PER_PIN;
+            clear_bits |= 0x07 << bit_offset;
+            set_bits |= function_code << bit_offset;
+        }
 
-    // Now set the bits
-    *(gpio_memory + calculate_offset(function_register)) |= function_code << bit_offset;
+        // Skip registers where every selected pin already has the requested function
+        if((atomic_load_explicit(&function_shadow[register_number], memory_order_relaxed) & clear_bits) == set_bits)
+        {
+            continue;
+        }
+
+        function_register = gpio_memory + calculate_offset(GPFSEL0) + register_number;
+
+        lock_register(GPFSEL0 + register_number * sizeof(Register_Type));
+        *function_register = (*function_register & ~clear_bits) | set_bits;
+        atomic_store_explicit(&function_shadow[register_number], *function_register, memory_order_relaxed);
+        unlock_register(GPFSEL0 + register_number * sizeof(Register_Type));
+    }
 
     return true;
 }
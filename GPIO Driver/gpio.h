@@ -31,18 +31,40 @@
 #ifndef GPIO_H
 #define GPIO_H
 
+#include <stdint.h>
+
 /*
  * Configuration
  */
 #define MEMORY_FILE "/dev/mem"
+#define GPIOMEM_FILE "/dev/gpiomem"
+#define SIMULATION_FILE_VARIABLE "PIO_SIMULATION_FILE"
+#define SIMULATION_FILE_MODE 0666
+#define SIMULATED_REVISION 2
+#define PULL_SETUP_TIME 1000 // Nanoseconds to hold GPPUD and GPPUDCLK (at least 150 core clock cycles)
+#define PROBE_CACHE_FILE "/run/pio.cache"
+#define PROBE_CACHE_MODE 0644
+#define DEVICE_TREE_REVISION_PATH "/proc/device-tree/system/linux,revision"
 #define CPU_INFO_PATH "/proc/cpuinfo"
 #define MAX_LINE_LENGTH 100
-#define CHIPSET_HEADER "Hardware\t: "
-#define CHIPSET "BCM2708"
-#define REVISION_HEADER "Revision\t: "
+#define REVISION_HEADER "Revision"
 #define REVISION_LENGTH 0x10000
-#define REVISION_1_START 0x02
-#define REVISION_2_START 0x04
+#define NEW_REVISION_FLAG 0x800000
+
+/*
+ * Concurrency Model
+ *
+ * - initialize_gpio, initialize_gpio_backend, and finalize_gpio are serialized with each other. No other library 
+ *   function may run while the library is being initialized or finalized.
+ * - Once initialized, the library state is only read, so any number of threads may use the library at once.
+ * - Data path functions (set, clear, get, masks, handles, and level snapshots) never lock. GPSET and GPCLR only 
+ *   change the pins whose bits are written, and GPLEV is only read, so these stores and loads are atomic by nature.
+ * - Function select changes are read-modify-writes on registers shared by 10 pins. Each function select register 
+ *   has its own lock, so only threads changing the mode of pins in the same register ever wait for each other, and 
+ *   nothing is locked when a pin is already in the requested mode. The detect enable registers are locked the 
+ *   same way.
+ * - Two threads must not drive the same pin at the same time. The last store wins.
+ */
 
 /*
  * Name: PinType
@@ -55,6 +77,16 @@ typedef enum {
 } PinType;
 
 
+/*
+ * Name: BackendType
+ * Description: BackendType specifies where the GPIO registers used by the library come from.
+ */
+typedef enum {
+    MEMORY_BACKEND, // The registers are mapped from /dev/mem (requires root).
+    GPIOMEM_BACKEND, // The registers are mapped from /dev/gpiomem (does not require root, GPIO registers only).
+    SIMULATED_BACKEND // The registers are simulated in ordinary memory (does not require a Raspberry Pi).
+} BackendType;
+
 /*
  * Name: StatusCode
  * Description: StatusCode specifies the result of the operation.
@@ -67,8 +99,78 @@ typedef enum {
 	NO_INIT, // The init function has not been completed successfully.
 	INVALID_PIN, // The pin number is not a pin number supported by the current pin type.
 	REGISTER_FAILURE, // There was an internal problem setting a register
+	UNSUPPORTED, // The operation is not supported by the current backend or pin configuration.
+	TIMED_OUT, // The operation did not complete before its timeout.
 } StatusCode;
 
+/*
+ * Name: PinMode
+ * Description: PinMode specifies the function of a pin. The values match the function codes in the GPFSEL registers.
+ */
+typedef enum {
+    MODE_INPUT = 0x00, // The pin is an input.
+    MODE_OUTPUT = 0x01, // The pin is an output.
+    MODE_ALT0 = 0x04, // The pin is routed to alternate function 0.
+    MODE_ALT1 = 0x05, // The pin is routed to alternate function 1.
+    MODE_ALT2 = 0x06, // The pin is routed to alternate function 2.
+    MODE_ALT3 = 0x07, // The pin is routed to alternate function 3.
+    MODE_ALT4 = 0x03, // The pin is routed to alternate function 4.
+    MODE_ALT5 = 0x02 // The pin is routed to alternate function 5.
+} PinMode;
+
+/*
+ * Name: PullMode
+ * Description: PullMode specifies the pull resistor of a pin. The values match the control codes of GPPUD.
+ */
+typedef enum {
+    PULL_OFF = 0x00, // No pull resistor.
+    PULL_DOWN = 0x01, // Pull-down resistor.
+    PULL_UP = 0x02 // Pull-up resistor.
+} PullMode;
+
+#define PULL_MODE_COUNT 3
+
+/*
+ * Name: PeripheralRegion
+ * Description: PeripheralRegion names the peripheral register blocks mapped next to the GPIO registers.
+ */
+typedef enum {
+    PWM_REGION, // The PWM controller.
+    CLOCK_REGION, // The clock manager (general purpose clocks and the PWM clock).
+    DMA_REGION, // The DMA channels.
+    TIMER_REGION // The system timer (not simulated).
+} PeripheralRegion;
+
+#define PERIPHERAL_REGION_COUNT 4
+
+/*
+ * Name: PinPull
+ * Description: Associates a pin with the pull resistor it should have.
+ */
+typedef struct {
+    int pin_number;
+    PullMode pull_mode;
+} PinPull;
+
+/*
+ * Name: PinMask
+ * Description: PinMask selects a group of pins. Bit n of the mask refers to pin n in the chosen numbering convention.
+ */
+typedef uint64_t PinMask;
+
+/*
+ * Name: PinHandle
+ * Description: PinHandle holds the register locations and bit mask of a GPIO pin that has already been checked by 
+ *              open_gpio_handle, so the pin can be accessed without any lookups or validation.
+ */
+typedef struct {
+    volatile unsigned int* set_register; // GPSET register of the bank that holds the pin.
+    volatile unsigned int* clear_register; // GPCLR register of the bank that holds the pin.
+    volatile unsigned int* level_register; // GPLEV register of the bank that holds the pin.
+    unsigned int bit_mask; // Bit of the pin within its bank.
+    int broadcom_number; // Broadcom pin number of the pin.
+} PinHandle;
+
 /*
  * Name: PhysicalPin
  * Description: Associates a physical pin number with the internal number used by the Broadcom CPU.
@@ -78,6 +180,21 @@ typedef struct {
     int broadcom_pin_number;
 } PhysicalPin;
 
+/*
+ * Physical Pin Tables
+ *
+ * Physical pin numbers and the Broadcom pin numbers they connect to, for each connector revision (revision 3 is the 
+ * 40 pin header of every later board). They initialize the pin tables of gpio.c and the compile time tables of 
+ * gpio.hpp, so both always agree.
+ */
+#define REVISION_1_PINS {{3, 0}, {5, 1}, {7, 4}, {8, 14}, {10, 15}, {11, 17}, {12, 18}, {13, 21}, {15, 22}, {16, 23}, \
+        {18, 24}, {19, 10}, {21, 9}, {22, 25}, {23, 11}, {24, 8}, {26, 7}}
+#define REVISION_2_PINS {{3, 2}, {5, 3}, {7, 4}, {8, 14}, {10, 15}, {11, 17}, {12, 18}, {13, 27}, {15, 22}, {16, 23}, \
+        {18, 24}, {19, 10}, {21, 9}, {22, 25}, {23, 11}, {24, 8}, {26, 7}}
+#define REVISION_3_PINS {{3, 2}, {5, 3}, {7, 4}, {8, 14}, {10, 15}, {11, 17}, {12, 18}, {13, 27}, {15, 22}, {16, 23}, \
+        {18, 24}, {19, 10}, {21, 9}, {22, 25}, {23, 11}, {24, 8}, {26, 7}, {27, 0}, {28, 1}, {29, 5}, {31, 6}, \
+        {32, 12}, {33, 13}, {35, 19}, {36, 16}, {37, 26}, {38, 20}, {40, 21}}
+
 /*
  * API Functions
  */
@@ -95,6 +212,53 @@ typedef struct {
  */
 StatusCode initialize_gpio();
 
+/*
+ * Name: initialize_gpio_backend
+ * Description: initialize_gpio_backend initializes the library like initialize_gpio, but maps the GPIO registers from 
+ *              the chosen backend.
+ *              - MEMORY_BACKEND behaves exactly like initialize_gpio.
+ *              - GPIOMEM_BACKEND maps /dev/gpiomem, which only exposes the GPIO registers and does not need root.
+ *              - SIMULATED_BACKEND maps an in-memory register file and skips the root and chipset checks. The file is 
+ *                anonymous memory, unless the PIO_SIMULATION_FILE environment variable names a file to share it 
+ *                through. The simulated revision is SIMULATED_REVISION. See simulator.h.
+ *              Calling it (or initialize_gpio) while the library is initialized releases the earlier mappings first, 
+ *              as finalize_gpio would.
+ * Parameters:
+ *       backend_type[in] - The backend used to access the GPIO registers.
+ * Returns: Result of the operation.
+ */
+StatusCode initialize_gpio_backend(BackendType backend_type);
+
+/*
+ * Name: get_gpio_revision
+ * Description: Gets the connector revision of the board (1 and 2 for the 26 pin P1 revisions, 3 for the 40 pin 
+ *              header), which selects the physical pin table.
+ * Parameters: None
+ * Returns: The revision, or 0 if the library is not initialized.
+ */
+int get_gpio_revision();
+
+/*
+ * Name: get_gpio_registers
+ * Description: Gets the mapped GPIO registers, for layers that compute register offsets themselves (gpio.hpp).
+ * Note: The pointer is only valid until finalize_gpio.
+ * Parameters: None
+ * Returns: The first GPIO register (GPFSEL0), or 0x00 if the library is not initialized.
+ */
+volatile unsigned int* get_gpio_registers();
+
+/*
+ * Name: get_gpio_peripheral_registers
+ * Description: Gets a mapped peripheral register block, for example to check the registers programmed in the 
+ *              simulated backend.
+ * Note: The pointer is only valid until finalize_gpio.
+ * Parameters:
+ *       region[in] - The peripheral register block.
+ * Returns: The first register of the block, or 0x00 if the library is not initialized or the block is not 
+ *          available from the current backend.
+ */
+volatile unsigned int* get_gpio_peripheral_registers(PeripheralRegion region);
+
 /*
  * Name: finalize_gpio
  * Description: finalize_gpio unmaps the memory location used by the Raspberry Pi's GPIO registers.
@@ -106,9 +270,86 @@ StatusCode initialize_gpio();
  */
 StatusCode finalize_gpio();
 
+/*
+ * Name: set_gpio_pin_mode
+ * Description: Sets the function of a GPIO pin. The function select registers are only written when the mode of the 
+ *              pin actually changes.
+ * Note: Must be called after initialize_gpio. The library keeps a copy of the function select registers that is read 
+ *       once by initialize_gpio, so pin modes must not be changed by other programs while the library is in use.
+ * Parameters:
+ *       pin_number[in] - The GPIO pin number to configure.
+ *       pin_type[in] - The numbering convention used to identify the GPIO pin.
+ *       pin_mode[in] - The function to give the GPIO pin.
+ * Returns: Result of the operation.
+ */
+StatusCode set_gpio_pin_mode(int pin_number, PinType pin_type, PinMode pin_mode);
+
+/*
+ * Name: get_gpio_pin_mode
+ * Description: Gets the current function of a GPIO pin.
+ * Note: Must be called after initialize_gpio.
+ * Parameters:
+ *       pin_number[in] - The GPIO pin number to retrieve the function of.
+ *       pin_type[in] - The numbering convention used to identify the GPIO pin.
+ *       pin_mode[out] - The current function of the GPIO pin.
+ * Returns: Result of the operation.
+ */
+StatusCode get_gpio_pin_mode(int pin_number, PinType pin_type, PinMode* pin_mode);
+
+/*
+ * Name: set_gpio_mask_mode
+ * Description: Sets the function of every GPIO pin selected by a mask, using at most one write per function select 
+ *              register.
+ * Note: Must be called after initialize_gpio.
+ * Parameters:
+ *       pin_mask[in] - The GPIO pins to configure.
+ *       pin_type[in] - The numbering convention used to identify the GPIO pins.
+ *       pin_mode[in] - The function to give the GPIO pins.
+ * Returns: Result of the operation.
+ */
+StatusCode set_gpio_mask_mode(PinMask pin_mask, PinType pin_type, PinMode pin_mode);
+
+/*
+ * Name: set_gpio_pin_pull
+ * Description: Sets the pull resistor of a GPIO pin.
+ * Note: Must be called after initialize_gpio. The hardware cannot read pull resistors back.
+ * Parameters:
+ *       pin_number[in] - The GPIO pin number to configure.
+ *       pin_type[in] - The numbering convention used to identify the GPIO pin.
+ *       pull_mode[in] - The pull resistor to give the GPIO pin.
+ * Returns: Result of the operation.
+ */
+StatusCode set_gpio_pin_pull(int pin_number, PinType pin_type, PullMode pull_mode);
+
+/*
+ * Name: set_gpio_mask_pull
+ * Description: Sets the pull resistor of every GPIO pin selected by a mask with a single GPPUD/GPPUDCLK sequence.
+ * Note: Must be called after initialize_gpio.
+ * Parameters:
+ *       pin_mask[in] - The GPIO pins to configure.
+ *       pin_type[in] - The numbering convention used to identify the GPIO pins.
+ *       pull_mode[in] - The pull resistor to give the GPIO pins.
+ * Returns: Result of the operation.
+ */
+StatusCode set_gpio_mask_pull(PinMask pin_mask, PinType pin_type, PullMode pull_mode);
+
+/*
+ * Name: set_gpio_pulls
+ * Description: Sets the pull resistors of a list of GPIO pins. The pins are grouped by pull mode, so each distinct 
+ *              mode costs one GPPUD/GPPUDCLK sequence no matter how many pins use it. Nothing is changed unless 
+ *              every pin is valid. If a pin is listed more than once, the last entry wins.
+ * Note: Must be called after initialize_gpio.
+ * Parameters:
+ *       pin_pulls[in] - The pins and their pull resistors.
+ *       pull_count[in] - Number of entries in pin_pulls.
+ *       pin_type[in] - The numbering convention used to identify the GPIO pins.
+ * Returns: Result of the operation.
+ */
+StatusCode set_gpio_pulls(const PinPull* pin_pulls, int pull_count, PinType pin_type);
+
 /*
  * Name: set_gpio_pin
- * Description: Sets a GPIO.
+ * Description: Sets a GPIO pin. The pin is switched to output mode first if it is not already an output.
  * Note: Must be called after initialize_gpio.
  * Parameters:
  *       pin_number[in] - The GPIO pin number to set.
@@ -119,7 +360,7 @@ StatusCode set_gpio_pin(int pin_number, PinType pin_type);
 
 /*
  * Name: clear_gpio_pin
- * Description: Clears a GPIO pin.
+ * Description: Clears a GPIO pin. The pin is switched to output mode first if it is not already an output.
  * Note: Must be called after initialize_gpio.
  * Parameters:
  *       pin_number[in] - The GPIO pin number to clear.
@@ -130,7 +371,8 @@ StatusCode clear_gpio_pin(int pin_number, PinType pin_type);
 
 /*
  * Name: get_gpio_pin
- * Description: Gets the current value of a GPIO pin.
+ * Description: Gets the current value of a GPIO pin. Inputs and outputs are read without changing their mode. A pin 
+ *              routed to an alternate function is switched to input mode first.
  * Note: Must be called after initialize_gpio.
  *       pin_number[in] - The GPIO pin number to retrieve a value from.
  *       pin_type[in] - The numbering convention used to identify the GPIO pin.
@@ -139,4 +381,108 @@ StatusCode clear_gpio_pin(int pin_number, PinType pin_type);
  */
 StatusCode get_gpio_pin(int pin_number, PinType pin_type, int* pin_value);
 
+/*
+ * Name: get_gpio_levels
+ * Description: Takes a snapshot of the levels of every GPIO pin with one load from each of GPLEV0 and GPLEV1, so all 
+ *              pins are sampled at nearly the same instant. The pin modes are not changed.
+ * Note: Must be called after initialize_gpio. P1 connector snapshots are remapped into P1 order through a table 
+ *       that initialize_gpio builds for the current revision.
+ * Parameters:
+ *       pin_mask[in] - The GPIO pins to include in the snapshot.
+ *       pin_type[in] - The numbering convention used by pin_mask and pin_values.
+ *       pin_values[out] - The levels of the selected pins. Bits outside of pin_mask are cleared.
+ * Returns: Result of the operation.
+ */
+StatusCode get_gpio_levels(PinMask pin_mask, PinType pin_type, PinMask* pin_values);
+
+/*
+ * Name: write_gpio_mask
+ * Description: Drives every pin selected by a mask to the level of the matching bit in a value. The pins are switched 
+ *              to output mode with one read-modify-write per function select register, and the levels are written 
+ *              with at most one store to each of GPSET0, GPSET1, GPCLR0, and GPCLR1, so pins in the same bank change 
+ *              at the same time.
+ * Note: Must be called after initialize_gpio.
+ * Parameters:
+ *       pin_mask[in] - The GPIO pins to drive.
+ *       pin_values[in] - The levels to drive the selected pins to. Bits outside of pin_mask are ignored.
+ *       pin_type[in] - The numbering convention used to identify the GPIO pins.
+ * Returns: Result of the operation.
+ */
+StatusCode write_gpio_mask(PinMask pin_mask, PinMask pin_values, PinType pin_type);
+
+/*
+ * Name: set_gpio_mask
+ * Description: Sets every GPIO pin selected by a mask.
+ * Note: Must be called after initialize_gpio.
+ * Parameters:
+ *       pin_mask[in] - The GPIO pins to set.
+ *       pin_type[in] - The numbering convention used to identify the GPIO pins.
+ * Returns: Result of the operation.
+ */
+StatusCode set_gpio_mask(PinMask pin_mask, PinType pin_type);
+
+/*
+ * Name: clear_gpio_mask
+ * Description: Clears every GPIO pin selected by a mask.
+ * Note: Must be called after initialize_gpio.
+ * Parameters:
+ *       pin_mask[in] - The GPIO pins to clear.
+ *       pin_type[in] - The numbering convention used to identify the GPIO pins.
+ * Returns: Result of the operation.
+ */
+StatusCode clear_gpio_mask(PinMask pin_mask, PinType pin_type);
+
+/*
+ * Name: open_gpio_handle
+ * Description: Validates a GPIO pin once, sets its function, and fills in a handle with the precomputed register 
+ *              locations and bit mask used by set_gpio_handle, clear_gpio_handle, and get_gpio_handle.
+ * Note: Must be called after initialize_gpio. A handle is no longer valid once finalize_gpio is called.
+ * Parameters:
+ *       pin_number[in] - The GPIO pin number to open.
+ *       pin_type[in] - The numbering convention used to identify the GPIO pin.
+ *       pin_mode[in] - The function to give the GPIO pin.
+ *       pin_handle[out] - The handle used to access the GPIO pin.
+ * Returns: Result of the operation.
+ */
+StatusCode open_gpio_handle(int pin_number, PinType pin_type, PinMode pin_mode, PinHandle* pin_handle);
+
+/*
+ * Name: set_gpio_handle
+ * Description: Sets the GPIO pin of a handle with a single register store.
+ * Note: No checks are made. The handle must have been opened successfully as an output.
+ * Parameters:
+ *       pin_handle[in] - The handle of the GPIO pin to set.
+ * Returns: None
+ */
+static inline void set_gpio_handle(const PinHandle* pin_handle)
+{
+    *pin_handle->set_register = pin_handle->bit_mask;
+}
+
+/*
+ * Name: clear_gpio_handle
+ * Description: Clears the GPIO pin of a handle with a single register store.
+ * Note: No checks are made. The handle must have been opened successfully as an output.
+ * Parameters:
+ *       pin_handle[in] - The handle of the GPIO pin to clear.
+ * Returns: None
+ */
+static inline void clear_gpio_handle(const PinHandle* pin_handle)
+{
+    *pin_handle->clear_register = pin_handle->bit_mask;
+}
+
+/*
+ * Name: get_gpio_handle
+ * Description: Gets the current value of the GPIO pin of a handle with a single register load.
+ * Note: No checks are made. The handle must have been opened successfully.
+ * Parameters:
+ *       pin_handle[in] - The handle of the GPIO pin to read.
+ * Returns: 1 if the pin is high, otherwise 0.
+ */
+static inline int get_gpio_handle(const PinHandle* pin_handle)
+{
+    return (*pin_handle->level_register & pin_handle->bit_mask) != 0;
+}
+
 #endif /* GPIO_H_ */
@@ -0,0 +1,344 @@
+/*
+ * File:        gpio.hpp
+ * Description: Header-only C++17 layer that resolves pins, register offsets, and bit masks at compile time.
+ * Programmer:  tnewman
+ * Date:        Oct 16, 2026
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 Thomas Newman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef GPIO_HPP
+#define GPIO_HPP
+
+extern "C" {
+#include "gpio.h"
+#include "register.h"
+}
+
+#include <cstddef>
+#include <utility>
+
+namespace pio
+{
+
+/*
+ * Name: Numbering
+ * Description: Numbering specifies the numbering convention of a pin template (see PinType).
+ */
+enum class Numbering
+{
+    Broadcom, // The pin numbers used by the Broadcom manual.
+    P1 // The physical pin numbers on the P1 connector (or 40 pin header).
+};
+
+constexpr Numbering Broadcom = Numbering::Broadcom;
+constexpr Numbering P1 = Numbering::P1;
+
+/*
+ * Name: Layout
+ * Description: Layout specifies the connector revision a physical pin number is resolved against. The values match 
+ *              get_gpio_revision. Any only resolves pins that connect to the same Broadcom pin on every revision.
+ */
+enum class Layout
+{
+    Any = 0,
+    Revision1 = 1,
+    Revision2 = 2,
+    Header40 = 3
+};
+
+/*
+ * Name: LayoutTag
+ * Description: Carries a Layout as a type, so code passed to with_layout can use it as a template argument.
+ */
+template <Layout L>
+struct LayoutTag
+{
+    static constexpr Layout value = L;
+};
+
+namespace detail
+{
+
+constexpr PhysicalPin REVISION_1[] = REVISION_1_PINS;
+constexpr PhysicalPin REVISION_2[] = REVISION_2_PINS;
+constexpr PhysicalPin REVISION_3[] = REVISION_3_PINS;
+
+// The mapped registers, cached by initialize
+inline volatile unsigned int* registers = nullptr;
+
+/*
+ * Name: find_broadcom
+ * Description: Looks a physical pin up in a pin table.
+ * Parameters:
+ *       table[in] - The pin table.
+ *       physical_number[in] - The physical pin number.
+ * Returns: The Broadcom pin number, or -1 if the pin does not connect to a Broadcom pin.
+ */
+template <std::size_t N>
+constexpr int find_broadcom(const PhysicalPin (&table)[N], int physical_number)
+{
+    for(std::size_t i = 0; i < N; i++)
+    {
+        if(table[i].physical_pin_number == physical_number)
+        {
+            return table[i].broadcom_pin_number;
+        }
+    }
+
+    return -1;
+}
+
+/*
+ * Name: to_broadcom
+ * Description: Resolves a pin to its Broadcom pin number.
+ * Parameters:
+ *       numbering[in] - The numbering convention of the pin.
+ *       number[in] - The pin number.
+ *       layout[in] - The connector revision (ignored for Broadcom pins).
+ * Returns: The Broadcom pin number, or -1 if the pin cannot be resolved.
+ */
+constexpr int to_broadcom(Numbering numbering, int number, Layout layout)
+{
+    int revision_1 = find_broadcom(REVISION_1, number);
+    int revision_2 = find_broadcom(REVISION_2, number);
+    int revision_3 = find_broadcom(REVISION_3, number);
+
+    if(numbering == Numbering::Broadcom)
+    {
+        return number >= 0 && number <= GPIO_PIN_COUNT ? number : -1;
+    }
+
+    switch(layout)
+    {
+    case Layout::Revision1:
+        return revision_1;
+    case Layout::Revision2:
+        return revision_2;
+    case Layout::Header40:
+        return revision_3;
+    default:
+        return revision_1 == revision_2 && revision_2 == revision_3 ? revision_1 : -1;
+    }
+}
+
+/*
+ * Name: offset
+ * Description: The constexpr counterpart of calculate_offset.
+ * Parameters:
+ *       register_address[in] - The register address from register.h.
+ * Returns: The index of the register in the mapped registers.
+ */
+constexpr unsigned int offset(unsigned int register_address)
+{
+    return (register_address - GPIO_MEMORY_START) / sizeof(Register_Type);
+}
+
+} // namespace detail
+
+/*
+ * Name: pin_exists
+ * Description: Whether a pin resolves to a Broadcom pin on a layout. Inside with_layout, a pin that only exists on 
+ *              some layouts (like the pins above 26 on the 40 pin header) is named in an if constexpr branch on this, 
+ *              so the layouts without it never instantiate it.
+ */
+template <Numbering N, int Number, Layout L = Layout::Any>
+inline constexpr bool pin_exists = detail::to_broadcom(N, Number, L) >= 0;
+
+/*
+ * Name: Pin
+ * Description: A GPIO pin known at compile time. The Broadcom number, register offsets, and bit mask are constants, 
+ *              so set and clear are a single volatile store and get is a single volatile load.
+ * Note: Physical pins that connect to different Broadcom pins on different revisions (for example P1 pin 3) need a 
+ *       Layout. Get one at run time with with_layout, and check pin_exists first for pins that some layouts lack.
+ */
+template <Numbering N, int Number, Layout L = Layout::Any>
+struct Pin
+{
+    static constexpr int broadcom_number = detail::to_broadcom(N, Number, L);
+
+    static_assert(broadcom_number >= 0, "The pin does not exist on this layout (or depends on the board revision, "
+            "so it needs a Layout from with_layout, inside if constexpr(pin_exists<...>) if some layouts lack it)");
+
+    static constexpr PinMask bit = PinMask(1) << broadcom_number;
+    static constexpr unsigned int bank = broadcom_number / REGISTER_SIZE;
+    static constexpr unsigned int mask = 1u << (broadcom_number % REGISTER_SIZE);
+    static constexpr unsigned int set_offset = detail::offset(GPSET0) + bank;
+    static constexpr unsigned int clear_offset = detail::offset(GPCLR0) + bank;
+    static constexpr unsigned int level_offset = detail::offset(GPLEV0) + bank;
+
+    // Sets the pin (the pin must already be an output)
+    static void set() { detail::registers[set_offset] = mask; }
+
+    // Clears the pin (the pin must already be an output)
+    static void clear() { detail::registers[clear_offset] = mask; }
+
+    // Drives the pin high or low
+    static void write(bool value) { detail::registers[value ? set_offset : clear_offset] = mask; }
+
+    // Gets the level of the pin
+    static bool get() { return (detail::registers[level_offset] & mask) != 0; }
+
+    // Sets the function of the pin
+    static StatusCode mode(PinMode pin_mode) { return set_gpio_pin_mode(broadcom_number, BROADCOM, pin_mode); }
+
+    static StatusCode output() { return mode(MODE_OUTPUT); }
+
+    static StatusCode input() { return mode(MODE_INPUT); }
+};
+
+/*
+ * Name: PinGroup
+ * Description: A group of Pin types folded into one Broadcom mask at compile time. set and clear are one store per 
+ *              register bank that holds a pin of the group, and write is at most one GPSET and one GPCLR store per 
+ *              bank. Bit i of the values of write and read refers to the i-th pin of the group.
+ */
+template <typename... Pins>
+struct PinGroup
+{
+    static constexpr PinMask bits = (Pins::bit | ... | PinMask(0));
+    static constexpr unsigned int low_mask = static_cast<unsigned int>(bits);
+    static constexpr unsigned int high_mask = static_cast<unsigned int>(bits >> REGISTER_SIZE);
+
+    static_assert(sizeof...(Pins) <= sizeof(PinMask) * 8, "A group holds at most 64 pins");
+
+    static void set()
+    {
+        if constexpr(low_mask != 0) detail::registers[detail::offset(GPSET0)] = low_mask;
+        if constexpr(high_mask != 0) detail::registers[detail::offset(GPSET1)] = high_mask;
+    }
+
+    static void clear()
+    {
+        if constexpr(low_mask != 0) detail::registers[detail::offset(GPCLR0)] = low_mask;
+        if constexpr(high_mask != 0) detail::registers[detail::offset(GPCLR1)] = high_mask;
+    }
+
+    static void write(PinMask values)
+    {
+        PinMask levels = scatter(values, std::index_sequence_for<Pins...>());
+
+        if constexpr(low_mask != 0)
+        {
+            detail::registers[detail::offset(GPSET0)] = static_cast<unsigned int>(levels) & low_mask;
+            detail::registers[detail::offset(GPCLR0)] = ~static_cast<unsigned int>(levels) & low_mask;
+        }
+
+        if constexpr(high_mask != 0)
+        {
+            detail::registers[detail::offset(GPSET1)] = static_cast<unsigned int>(levels >> REGISTER_SIZE) & high_mask;
+            detail::registers[detail::offset(GPCLR1)] = ~static_cast<unsigned int>(levels >> REGISTER_SIZE) & high_mask;
+        }
+    }
+
+    static PinMask read()
+    {
+        PinMask levels = 0;
+
+        if constexpr(low_mask != 0) levels |= detail::registers[detail::offset(GPLEV0)];
+        if constexpr(high_mask != 0) levels |= PinMask(detail::registers[detail::offset(GPLEV1)]) << REGISTER_SIZE;
+
+        return gather(levels, std::index_sequence_for<Pins...>());
+    }
+
+    static StatusCode mode(PinMode pin_mode) { return set_gpio_mask_mode(bits, BROADCOM, pin_mode); }
+
+    static StatusCode output() { return mode(MODE_OUTPUT); }
+
+    static StatusCode input() { return mode(MODE_INPUT); }
+
+private:
+    // Moves bit i of values to the Broadcom bit of the i-th pin
+    template <std::size_t... I>
+    static PinMask scatter(PinMask values, std::index_sequence<I...>)
+    {
+        return (((values >> I) & 1 ? Pins::bit : PinMask(0)) | ... | PinMask(0));
+    }
+
+    // Moves the Broadcom bit of the i-th pin to bit i
+    template <std::size_t... I>
+    static PinMask gather(PinMask levels, std::index_sequence<I...>)
+    {
+        return (((levels & Pins::bit) ? PinMask(1) << I : PinMask(0)) | ... | PinMask(0));
+    }
+};
+
+/*
+ * Name: initialize
+ * Description: Initializes the library and caches the register pointer used by Pin and PinGroup.
+ * Parameters:
+ *       backend_type[in] - The backend used to access the GPIO registers.
+ * Returns: Result of the operation.
+ */
+inline StatusCode initialize(BackendType backend_type = MEMORY_BACKEND)
+{
+    StatusCode status = initialize_gpio_backend(backend_type);
+
+    detail::registers = status == SUCCESS ? get_gpio_registers() : nullptr;
+
+    return status;
+}
+
+/*
+ * Name: finalize
+ * Description: Finalizes the library. Pin and PinGroup must not be used afterwards.
+ * Parameters: None
+ * Returns: Result of the operation.
+ */
+inline StatusCode finalize()
+{
+    detail::registers = nullptr;
+
+    return finalize_gpio();
+}
+
+/*
+ * Name: with_layout
+ * Description: Calls a function once with the LayoutTag of the board, so revision-dependent pins inside it are 
+ *              resolved at compile time for each layout and the revision is only checked here, not on every call.
+ * Note: Must be called after initialize. The function is instantiated for every layout, so pins that only some 
+ *       layouts have must be guarded with if constexpr(pin_exists<...>).
+ * Parameters:
+ *       function[in] - A generic callable taking a LayoutTag, for example [](auto layout) { ... } using 
+ *                      Pin<P1, 3, decltype(layout)::value>.
+ * Returns: What the function returns.
+ */
+template <typename Function>
+decltype(auto) with_layout(Function&& function)
+{
+    switch(get_gpio_revision())
+    {
+    case 1:
+        return function(LayoutTag<Layout::Revision1>());
+    case 2:
+        return function(LayoutTag<Layout::Revision2>());
+    default:
+        return function(LayoutTag<Layout::Header40>());
+    }
+}
+
+} // namespace pio
+
+#endif /* GPIO_HPP_ */
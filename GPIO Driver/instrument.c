@@ -0,0 +1,272 @@
+/*
+ * File:        instrument.c
+ * Description: Hot path instrumentation implementation.
+ * Programmer:  tnewman
+ * Date:        Oct 16, 2026
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 Thomas Newman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "instrument.h"
+#include "internal.h"
+
+#ifdef PIO_INSTRUMENTATION
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Name: InstrumentCounters
+ * Description: Counters of one operation on one pin.
+ */
+typedef struct {
+    atomic_uint status_counts[INSTRUMENT_STATUS_COUNT];
+    atomic_uint latency_buckets[INSTRUMENT_BUCKET_COUNT];
+} InstrumentCounters;
+
+/*
+ * Name: ThreadInstrument
+ * Description: The counters of one thread. Only the owning thread writes them, with plain relaxed loads and stores 
+ *              instead of read-modify-writes, so counting never contends between threads.
+ */
+typedef struct ThreadInstrument {
+    atomic_uint generation; // Reset generation the counters belong to.
+    InstrumentCounters counters[INSTRUMENT_OPERATION_COUNT][INSTRUMENT_PIN_COUNT];
+    struct ThreadInstrument* next; // Next thread in instrument_threads.
+} ThreadInstrument;
+
+/*
+ * Global Variables
+ */
+const char* INSTRUMENT_OPERATION_NAMES[] = {"set_gpio_pin", "clear_gpio_pin", "get_gpio_pin", "set_gpio_pin_mode", 
+        "write_gpio_mask", "get_gpio_levels"};
+const char* INSTRUMENT_STATUS_NAMES[] = {"SUCCESS", "NOT_ROOT", "INVALID_CHIPSET", "CANNOT_MAP_MEMORY", "NO_INIT", 
+        "INVALID_PIN", "REGISTER_FAILURE", "UNSUPPORTED", "TIMED_OUT"};
+_Thread_local ThreadInstrument* thread_instrument = 0x00; // Counters of the calling thread
+ThreadInstrument* instrument_threads = 0x00; // Counters of every thread that has been instrumented
+pthread_mutex_t instrument_threads_lock = PTHREAD_MUTEX_INITIALIZER; // Protects instrument_threads
+atomic_uint instrument_generation = 1; // Incremented by every reset
+
+/*
+ * Implementation Functions
+ *
+ * These functions are for internal use only.
+ */
+
+/*
+ * Name: increment
+ * Description: Increments a counter owned by the calling thread.
+ * Parameters:
+ *       counter[in,out] - The counter.
+ * Returns: None
+ */
+static inline void increment(atomic_uint* counter)
+{
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + 1, memory_order_relaxed);
+}
+
+/*
+ * Name: get_thread_instrument
+ * Description: Gets the counters of the calling thread, creating them on the first call and clearing them after a 
+ *              reset.
+ * Parameters: None
+ * Returns: The counters, or 0x00 if they cannot be allocated.
+ */
+static ThreadInstrument* get_thread_instrument();
+
+void record_instrument(InstrumentOperation operation, int pin_number, PinType pin_type, StatusCode status, 
+        uint64_t start_time)
+{
+    uint64_t latency = get_instrument_time() - start_time;
+    ThreadInstrument* instrument = get_thread_instrument();
+    InstrumentCounters* counters;
+    int bucket;
+
+    if(instrument == 0x00)
+    {
+        return;
+    }
+
+    // Physical pins share the counters of the Broadcom pins they are wired to
+    if(pin_number == INSTRUMENT_NO_PIN || !pin_to_broadcom(pin_number, pin_type, &pin_number) || 
+       pin_number >= INSTRUMENT_NO_PIN)
+    {
+        pin_number = INSTRUMENT_NO_PIN;
+    }
+
+    // Bucket n holds latencies from 2^(n-1) up to 2^n nanoseconds
+    bucket = latency == 0 ? 0 : 64 - __builtin_clzll(latency);
+
+    if(bucket >= INSTRUMENT_BUCKET_COUNT)
+    {
+        bucket = INSTRUMENT_BUCKET_COUNT - 1;
+    }
+
+    counters = &instrument->counters[operation][pin_number];
+    increment(&counters->status_counts[status < INSTRUMENT_STATUS_COUNT ? status : REGISTER_FAILURE]);
+    increment(&counters->latency_buckets[bucket]);
+}
+
+void dump_gpio_instrumentation(FILE* file)
+{
+    unsigned int generation = atomic_load_explicit(&instrument_generation, memory_order_acquire);
+    uint64_t status_counts[INSTRUMENT_STATUS_COUNT];
+    uint64_t latency_buckets[INSTRUMENT_BUCKET_COUNT];
+    uint64_t calls;
+    ThreadInstrument* instrument;
+    int operation;
+    int pin_number;
+    int i;
+
+    pthread_mutex_lock(&instrument_threads_lock);
+
+    for(operation = 0; operation < INSTRUMENT_OPERATION_COUNT; operation++)
+    {
+        for(pin_number = 0; pin_number < INSTRUMENT_PIN_COUNT; pin_number++)
+        {
+            memset(status_counts, 0x00, sizeof(status_counts));
+            memset(latency_buckets, 0x00, sizeof(latency_buckets));
+
+            // Threads that have not cleared their counters since the last reset are skipped
+            for(instrument = instrument_threads; instrument != 0x00; instrument = instrument->next)
+            {
+                if(atomic_load_explicit(&instrument->generation, memory_order_acquire) != generation)
+                {
+                    continue;
+                }
+
+                for(i = 0; i < INSTRUMENT_STATUS_COUNT; i++)
+                {
+                    status_counts[i] += atomic_load_explicit(
+                            &instrument->counters[operation][pin_number].status_counts[i], memory_order_relaxed);
+                }
+
+                for(i = 0; i < INSTRUMENT_BUCKET_COUNT; i++)
+                {
+                    latency_buckets[i] += atomic_load_explicit(
+                            &instrument->counters[operation][pin_number].latency_buckets[i], memory_order_relaxed);
+                }
+            }
+
+            calls = 0;
+
+            for(i = 0; i < INSTRUMENT_STATUS_COUNT; i++)
+            {
+                calls += status_counts[i];
+            }
+
+            if(calls == 0)
+            {
+                continue;
+            }
+
+            if(pin_number == INSTRUMENT_NO_PIN)
+            {
+                fprintf(file, "%s - calls %llu", INSTRUMENT_OPERATION_NAMES[operation], 
+                        (unsigned long long) calls);
+            }
+            else
+            {
+                fprintf(file, "%s %d calls %llu", INSTRUMENT_OPERATION_NAMES[operation], pin_number, 
+                        (unsigned long long) calls);
+            }
+
+            for(i = 0; i < INSTRUMENT_STATUS_COUNT; i++)
+            {
+                if(status_counts[i] != 0)
+                {
+                    fprintf(file, " %s %llu", INSTRUMENT_STATUS_NAMES[i], (unsigned long long) status_counts[i]);
+                }
+            }
+
+            fprintf(file, " latency");
+
+            for(i = 0; i < INSTRUMENT_BUCKET_COUNT; i++)
+            {
+                if(latency_buckets[i] != 0)
+                {
+                    fprintf(file, " %llu:%llu", 1ULL << i, (unsigned long long) latency_buckets[i]);
+                }
+            }
+
+            fprintf(file, "\n");
+        }
+    }
+
+    pthread_mutex_unlock(&instrument_threads_lock);
+}
+
+void reset_gpio_instrumentation()
+{
+    atomic_fetch_add_explicit(&instrument_generation, 1, memory_order_acq_rel);
+}
+
+static ThreadInstrument* get_thread_instrument()
+{
+    unsigned int generation = atomic_load_explicit(&instrument_generation, memory_order_acquire);
+    ThreadInstrument* instrument = thread_instrument;
+
+    if(instrument == 0x00)
+    {
+        // The counters are never freed, so the calls of threads that have exited are still dumped
+        instrument = calloc(1, sizeof(ThreadInstrument));
+
+        if(instrument == 0x00)
+        {
+            return 0x00;
+        }
+
+        atomic_store_explicit(&instrument->generation, generation, memory_order_relaxed);
+
+        pthread_mutex_lock(&instrument_threads_lock);
+        instrument->next = instrument_threads;
+        instrument_threads = instrument;
+        pthread_mutex_unlock(&instrument_threads_lock);
+
+        thread_instrument = instrument;
+    }
+    else if(atomic_load_explicit(&instrument->generation, memory_order_relaxed) != generation)
+    {
+        memset(instrument->counters, 0x00, sizeof(instrument->counters));
+        atomic_store_explicit(&instrument->generation, generation, memory_order_release);
+    }
+
+    return instrument;
+}
+
+#else
+
+void dump_gpio_instrumentation(FILE* file)
+{
+    fprintf(file, "instrumentation disabled (build with PIO_INSTRUMENTATION)\n");
+}
+
+void reset_gpio_instrumentation()
+{
+}
+
+#endif /* PIO_INSTRUMENTATION */
@@ -0,0 +1,139 @@
+/*
+ * File:        instrument.h
+ * Description: Definition of the optional hot path instrumentation (per-thread call counters and latency histograms).
+ * Programmer:  tnewman
+ * Date:        Oct 16, 2026
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 Thomas Newman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef INSTRUMENT_H
+#define INSTRUMENT_H
+
+#include "gpio.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+/*
+ * Configuration
+ */
+#define INSTRUMENT_PIN_COUNT 65 // Pins 0 to 63, plus one slot for mask operations and out of range pins
+#define INSTRUMENT_NO_PIN (INSTRUMENT_PIN_COUNT - 1)
+#define INSTRUMENT_BUCKET_COUNT 32 // Bucket n counts latencies below 2^n nanoseconds (the last bucket is open)
+#define INSTRUMENT_STATUS_COUNT (TIMED_OUT + 1)
+
+/*
+ * Name: InstrumentOperation
+ * Description: The API functions that are instrumented.
+ */
+typedef enum {
+    INSTRUMENT_SET_PIN, // set_gpio_pin
+    INSTRUMENT_CLEAR_PIN, // clear_gpio_pin
+    INSTRUMENT_GET_PIN, // get_gpio_pin
+    INSTRUMENT_SET_PIN_MODE, // set_gpio_pin_mode
+    INSTRUMENT_WRITE_MASK, // write_gpio_mask, set_gpio_mask, and clear_gpio_mask
+    INSTRUMENT_GET_LEVELS, // get_gpio_levels
+    INSTRUMENT_OPERATION_COUNT
+} InstrumentOperation;
+
+/*
+ * Name: dump_gpio_instrumentation
+ * Description: Writes the counters of every thread, added together, to a file. There is one line for each 
+ *              operation and pin that was called: the operation, the Broadcom pin (or - for mask operations and 
+ *              invalid pins), the number of calls, the count of every status that was returned, and the latency 
+ *              histogram as upper_bound_ns:count pairs.
+ * Note: Only writes a note if the library was built without PIO_INSTRUMENTATION.
+ * Parameters:
+ *       file[in] - The file to write to.
+ * Returns: None
+ */
+void dump_gpio_instrumentation(FILE* file);
+
+/*
+ * Name: reset_gpio_instrumentation
+ * Description: Resets the counters of every thread. Each thread clears its own counters on its next instrumented 
+ *              call, so the counting threads never have to synchronize with the reset.
+ * Parameters: None
+ * Returns: None
+ */
+void reset_gpio_instrumentation();
+
+/*
+ * Instrumentation Hooks
+ *
+ * INSTRUMENTED runs an API call and returns its status. With PIO_INSTRUMENTATION defined, the call is timed and 
+ * recorded; without it, the macro is a plain return, so the instrumented functions compile to the same code as 
+ * before.
+ */
+#ifdef PIO_INSTRUMENTATION
+
+/*
+ * Name: record_instrument
+ * Description: Records one call in the counters of the calling thread. The pin is counted by its Broadcom number, 
+ *              so calls that name the same pin in different numberings share a counter.
+ * Parameters:
+ *       operation[in] - The operation that was called.
+ *       pin_number[in] - The pin passed to the operation, or INSTRUMENT_NO_PIN.
+ *       pin_type[in] - The numbering convention used by pin_number.
+ *       status[in] - The status returned by the operation.
+ *       start_time[in] - get_instrument_time() before the call.
+ * Returns: None
+ */
+void record_instrument(InstrumentOperation operation, int pin_number, PinType pin_type, StatusCode status, 
+        uint64_t start_time);
+
+/*
+ * Name: get_instrument_time
+ * Description: Reads the monotonic clock.
+ * Parameters: None
+ * Returns: The current time in nanoseconds.
+ */
+static inline uint64_t get_instrument_time()
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return (uint64_t) time.tv_sec * 1000000000ULL + time.tv_nsec;
+}
+
+#define INSTRUMENTED(operation, pin_number, pin_type, call) \
+    do \
+    { \
+        uint64_t instrument_start = get_instrument_time(); \
+        StatusCode instrument_status = (call); \
+        record_instrument((operation), (pin_number), (pin_type), instrument_status, instrument_start); \
+        return instrument_status; \
+    } while(0)
+
+#else
+
+#define INSTRUMENTED(operation, pin_number, pin_type, call) return (call)
+
+#endif /* PIO_INSTRUMENTATION */
+
+#endif /* INSTRUMENT_H_ */
@@ -0,0 +1,281 @@
+/*
+ * File:        internal.h
+ * Description: Library state shared between the GPIO library source files. Not part of the public API.
+ * Programmer:  tnewman
+ * Date:        Oct 16, 2026
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 Thomas Newman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef INTERNAL_H
+#define INTERNAL_H
+
+#include "gpio.h"
+#include "register.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Configuration
+ */
+#define LOCK_SPINS 100
+
+/*
+ * Name: SimulatedGpio
+ * Description: Layout of the simulated register file used by SIMULATED_BACKEND. The registers come first, so the
+ *              simulation can be used through gpio_memory exactly like the real registers.
+ */
+typedef struct {
+    Register_Type registers[GPIO_MEMORY_SIZE / sizeof(Register_Type)]; // Simulated GPIO registers.
+    PinMask output_latch; // Levels driven by output pins (Broadcom numbering).
+    PinMask input_levels; // Levels driven onto the pins from outside (Broadcom numbering).
+    Register_Type pwm_registers[PWM_MEMORY_SIZE / sizeof(Register_Type)]; // Simulated PWM registers.
+    Register_Type clock_registers[CM_MEMORY_SIZE / sizeof(Register_Type)]; // Simulated clock manager registers.
+    Register_Type dma_registers[DMA_MEMORY_SIZE / sizeof(Register_Type)]; // Simulated DMA registers.
+} SimulatedGpio;
+
+/*
+ * Name: DmaControlBlock
+ * Description: A DMA control block as read by the DMA engines (32 byte aligned, bus addresses only).
+ */
+typedef struct {
+    uint32_t transfer_information; // Transfer information (DMA_TI fields).
+    uint32_t source_address; // Bus address to read from.
+    uint32_t destination_address; // Bus address to write to.
+    uint32_t transfer_length; // Bytes to transfer.
+    uint32_t stride; // Strides of 2D transfers (unused).
+    uint32_t next_control_block; // Bus address of the next control block, or 0 to stop.
+    uint32_t reserved[2];
+} DmaControlBlock;
+
+/*
+ * Name: DmaWaveform
+ * Description: A waveform compiled into a chain of DMA control blocks, followed by the data they copy, in memory 
+ *              that the DMA engines can read.
+ */
+struct DmaWaveform {
+    int channel; // DMA channel playing the waveform, or -1.
+    unsigned int tick; // Length of a pacing tick in nanoseconds.
+    int control_block_count; // Number of control blocks in the chain.
+    int last_control_block; // Index of the control block that ends the chain.
+    volatile DmaControlBlock* control_blocks; // The chain (start of the memory).
+    uint32_t bus_address; // Bus address of the memory.
+    size_t memory_size; // Size of the memory.
+    unsigned int memory_handle; // Mailbox handle of the memory, or 0 for simulated memory.
+};
+
+/*
+ * Name: BoardInfo
+ * Description: What the hardware probe found out about the board.
+ */
+typedef struct {
+    unsigned int revision_code; // Revision code reported by the firmware.
+    int revision; // Pin table of the connector (1 and 2 for the 26 pin P1 revisions, 3 for the 40 pin header).
+    uint32_t peripheral_base; // Physical address of the peripherals.
+} BoardInfo;
+
+/*
+ * Library State (defined in gpio.c)
+ */
+extern volatile Register_Type* gpio_memory; // Memory address of mapped GPIO memory
+extern size_t gpio_memory_size; // Size of the mapped GPIO memory
+extern BackendType backend; // Where the GPIO memory is mapped from
+extern volatile Register_Type* peripheral_memory[PERIPHERAL_REGION_COUNT]; // Mapped peripheral register blocks
+extern int revision; // CPU Revision of the current Raspberry Pi
+extern uint32_t peripheral_base; // Physical address of the peripherals of the current Raspberry Pi
+extern atomic_uint function_shadow[GPFSEL_REGISTER_COUNT]; // Copy of the function select registers
+extern atomic_uint register_locks[GPIO_MEMORY_SIZE / sizeof(Register_Type)]; // One lock per GPIO register
+
+/*
+ * Library State (defined in pwm.c)
+ */
+extern pthread_mutex_t peripheral_lock; // Serializes PWM and clock manager programming
+
+/*
+ * Internal Functions (defined in pwm.c)
+ */
+
+/*
+ * Name: start_pwm_clock
+ * Description: Starts the PWM clock from the oscillator divided by PWM_CLOCK_DIVISOR unless it already runs that way. 
+ *              Must be called with peripheral_lock held, after checking that the PWM and clock manager registers are 
+ *              mapped.
+ * Parameters: None
+ * Returns: The frequency of the PWM clock in Hz, or 0 if the clocks of the chip are not known.
+ */
+unsigned int start_pwm_clock();
+
+/*
+ * Internal Functions (defined in probe.c)
+ */
+
+/*
+ * Name: probe_board
+ * Description: Identifies the board from the probe cache, the device tree, or /proc/cpuinfo (in that order), and 
+ *              caches the result for later processes.
+ * Parameters:
+ *       board_info[out] - The board.
+ * Returns: true if the board is a known Raspberry Pi, otherwise false.
+ */
+bool probe_board(BoardInfo* board_info);
+
+/*
+ * Internal Functions (defined in gpio.c)
+ */
+
+/*
+ * Name: check_init
+ * Description: Checks that the memory has been mapped and the CPU revision has 
+ *              been set.
+ * Parameters: None
+ * Returns: true if memory is mapped and CPU revision is set, otherwise false.
+ */
+bool check_init();
+
+/*
+ * Name: pin_to_broadcom
+ * Description: Retrieves the Broadcom pin number based on the chosen numbering
+ *              convention.
+ * Parameters:
+ *       pin_number[in] - The GPIO member to retrieve a value from.
+ *       pin_type[in] - The numbering convention used to identify the GPIO pin.
+ *       broadcom_number[out] - The Broadcom pin number of the supplied pin.
+ * Returns: true if a match was found between the pin number and Broadcom number, 
+ *          otherwise false.
+ */
+bool pin_to_broadcom(int pin_number, PinType pin_type, int* broadcom_number);
+
+/*
+ * Name: get_gpio_pin_function
+ * Description: Retrieves the register function of a Broadcom pin from the shadow copy.
+ * Parameters:
+ *       broadcom_number[in] - The Broadcom pin to get the register function of.
+ * Returns: The register function number.
+ */
+int get_gpio_pin_function(int broadcom_number);
+
+/*
+ * Name: set_gpio_pin_function
+ * Description: Sets the register function of a Broadcom pin. The register is only written when the function 
+ *              differs from the shadow copy.
+ * Parameters:
+ *       broadcom_number[in] - The Broadcom pin to set the register function of.
+ *       function_code[in] - The register function number.
+ * Returns: true if register function is changed successfully, otherwise false.
+ */
+bool set_gpio_pin_function(int broadcom_number, int function_code);
+
+/*
+ * Name: mask_to_broadcom
+ * Description: Converts a pin mask and its values to Broadcom pin numbering.
+ * Parameters:
+ *       pin_mask[in] - The pins selected in the chosen numbering convention.
+ *       pin_values[in] - The values of the selected pins in the chosen numbering convention.
+ *       pin_type[in] - The numbering convention used to identify the pins.
+ *       broadcom_mask[out] - The selected pins in Broadcom numbering.
+ *       broadcom_values[out] - The values of the selected pins in Broadcom numbering.
+ * Returns: true if every selected pin maps to a Broadcom pin number, otherwise false.
+ */
+bool mask_to_broadcom(PinMask pin_mask, PinMask pin_values, PinType pin_type, PinMask* broadcom_mask, 
+        PinMask* broadcom_values);
+
+/*
+ * Name: set_gpio_mask_function
+ * Description: Sets the register function of every Broadcom pin in a mask, using a single read-modify-write 
+ *              for each function select register that needs to change.
+ * Parameters:
+ *       broadcom_mask[in] - The Broadcom pins to set the register function of.
+ *       function_code[in] - The register function number.
+ * Returns: true if register functions are changed successfully, otherwise false.
+ */
+bool set_gpio_mask_function(PinMask broadcom_mask, int function_code);
+
+
+/*
+ * Name: close_edge_files
+ * Description: Closes every kernel event file opened by the edge detection functions (defined in edge.c).
+ * Parameters: None
+ * Returns: None
+ */
+void close_edge_files();
+
+/*
+ * Name: read_register_pair
+ * Description: Reads a pair of bank registers (such as GPLEV0 and GPLEV1) as a single mask.
+ * Parameters:
+ *       register_address[in] - Address of the register for the first bank.
+ * Returns: The first register in the low 32 bits and the second register in the high 32 bits.
+ */
+static inline PinMask read_register_pair(unsigned int register_address)
+{
+    return gpio_memory[calculate_offset(register_address)] | 
+            (PinMask) gpio_memory[calculate_offset(register_address) + 1] << REGISTER_SIZE;
+}
+
+/*
+ * Name: lock_register
+ * Description: Takes the lock of a GPIO register before a read-modify-write. The lock spins, because the critical 
+ *              sections are a single read-modify-write, and yields every LOCK_SPINS attempts in case the holder was 
+ *              preempted.
+ * Parameters:
+ *       register_address[in] - Address of the register to lock.
+ * Returns: None
+ */
+static inline void lock_register(unsigned int register_address)
+{
+    atomic_uint* lock = &register_locks[calculate_offset(register_address)];
+    int spins = 0;
+
+    while(atomic_exchange_explicit(lock, 1, memory_order_acquire) != 0)
+    {
+        while(atomic_load_explicit(lock, memory_order_relaxed) != 0)
+        {
+            if(++spins >= LOCK_SPINS)
+            {
+                sched_yield();
+                spins = 0;
+            }
+        }
+    }
+}
+
+/*
+ * Name: unlock_register
+ * Description: Releases the lock of a GPIO register.
+ * Parameters:
+ *       register_address[in] - Address of the register to unlock.
+ * Returns: None
+ */
+static inline void unlock_register(unsigned int register_address)
+{
+    atomic_store_explicit(&register_locks[calculate_offset(register_address)], 0, memory_order_release);
+}
+
+#endif /* INTERNAL_H_ */
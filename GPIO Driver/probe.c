@@ -0,0 +1,299 @@
+/*
+ * File:        probe.c
+ * Description: Identifies the Raspberry Pi board and caches the result for later processes.
+ * Programmer:  tnewman
+ * Date:        Oct 16, 2026
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 Thomas Newman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "internal.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*
+ * Configuration
+ */
+#define NEW_STYLE_REVISION 3
+#define PROCESSOR_SHIFT 12
+#define PROCESSOR_BITS 0x0F
+
+/*
+ * Name: OldStyleBoard
+ * Description: A range of old style revision codes that share a pin table.
+ */
+typedef struct {
+    unsigned int first_code;
+    unsigned int last_code;
+    int revision;
+} OldStyleBoard;
+
+/*
+ * Board Tables
+ *
+ * Old style revision codes (before the Raspberry Pi 2) are plain numbers on a BCM2835. New style codes have 
+ * NEW_REVISION_FLAG set and the processor in bits 12 to 15; every new style board has the 40 pin header.
+ */
+const OldStyleBoard OLD_STYLE_BOARDS[] = {{0x02, 0x03, 1}, {0x04, 0x0F, 2}, {0x10, 0x15, 3}};
+const uint32_t PROCESSOR_PERIPHERAL_BASES[] = {BCM2835_PERIPHERAL_BASE, BCM2836_PERIPHERAL_BASE, 
+        BCM2836_PERIPHERAL_BASE, BCM2711_PERIPHERAL_BASE}; // BCM2835, BCM2836, BCM2837, BCM2711
+
+/*
+ * Implementation Functions
+ *
+ * These functions are for internal use only.
+ */
+
+/*
+ * Name: decode_revision
+ * Description: Looks a revision code up in the board tables.
+ * Parameters:
+ *       revision_code[in] - Revision code reported by the firmware.
+ *       board_info[out] - The board.
+ * Returns: true if the revision code belongs to a supported board, otherwise false.
+ */
+static bool decode_revision(unsigned int revision_code, BoardInfo* board_info);
+
+/*
+ * Name: read_cache
+ * Description: Reads the revision code saved by an earlier process. /run is emptied at boot, so the cache never 
+ *              outlives the board it describes.
+ * Parameters:
+ *       revision_code[out] - The cached revision code.
+ * Returns: true if the cache holds a revision code, otherwise false.
+ */
+static bool read_cache(unsigned int* revision_code);
+
+/*
+ * Name: write_cache
+ * Description: Saves a revision code for later processes. The cache is replaced with a rename, so readers never 
+ *              see a partial file. Failures are ignored (only root can write to /run).
+ * Parameters:
+ *       revision_code[in] - The revision code.
+ * Returns: None
+ */
+static void write_cache(unsigned int revision_code);
+
+/*
+ * Name: read_device_tree
+ * Description: Reads the revision code from the device tree (a single 4 byte big-endian value).
+ * Parameters:
+ *       revision_code[out] - The revision code.
+ * Returns: true if the device tree has a revision code, otherwise false.
+ */
+static bool read_device_tree(unsigned int* revision_code);
+
+/*
+ * Name: read_cpu_info
+ * Description: Reads the revision code from /proc/cpuinfo, stopping at the revision line.
+ * Parameters:
+ *       revision_code[out] - The revision code.
+ * Returns: true if /proc/cpuinfo has a revision line, otherwise false.
+ */
+static bool read_cpu_info(unsigned int* revision_code);
+
+bool probe_board(BoardInfo* board_info)
+{
+    unsigned int revision_code;
+
+    if(read_cache(&revision_code) && decode_revision(revision_code, board_info))
+    {
+        return true;
+    }
+
+    if(!read_device_tree(&revision_code) && !read_cpu_info(&revision_code))
+    {
+        return false;
+    }
+
+    if(!decode_revision(revision_code, board_info))
+    {
+        return false;
+    }
+
+    write_cache(revision_code);
+
+    return true;
+}
+
+static bool decode_revision(unsigned int revision_code, BoardInfo* board_info)
+{
+    unsigned int processor;
+    unsigned int old_style_code;
+    int i;
+
+    board_info->revision_code = revision_code;
+
+    if(revision_code & NEW_REVISION_FLAG)
+    {
+        processor = (revision_code >> PROCESSOR_SHIFT) & PROCESSOR_BITS;
+
+        // Later processors (the BCM2712) do not have these GPIO registers
+        if(processor >= sizeof(PROCESSOR_PERIPHERAL_BASES) / sizeof(PROCESSOR_PERIPHERAL_BASES[0]))
+        {
+            return false;
+        }
+
+        board_info->revision = NEW_STYLE_REVISION;
+        board_info->peripheral_base = PROCESSOR_PERIPHERAL_BASES[processor];
+
+        return true;
+    }
+
+    // Overvolted Raspberry Pi's are prefixed with 1000. Ignore it.
+    old_style_code = revision_code % REVISION_LENGTH;
+
+    for(i = 0; i < (int) (sizeof(OLD_STYLE_BOARDS) / sizeof(OldStyleBoard)); i++)
+    {
+        if(old_style_code >= OLD_STYLE_BOARDS[i].first_code && old_style_code <= OLD_STYLE_BOARDS[i].last_code)
+        {
+            board_info->revision = OLD_STYLE_BOARDS[i].revision;
+            board_info->peripheral_base = BCM2835_PERIPHERAL_BASE;
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool read_cache(unsigned int* revision_code)
+{
+    char cache[MAX_LINE_LENGTH];
+    char* end;
+    ssize_t length;
+    int cache_file;
+
+    cache_file = open(PROBE_CACHE_FILE, O_RDONLY | O_CLOEXEC);
+
+    if(cache_file < 0)
+    {
+        return false;
+    }
+
+    length = read(cache_file, cache, sizeof(cache) - 1);
+    close(cache_file);
+
+    if(length <= 0)
+    {
+        return false;
+    }
+
+    cache[length] = '\0';
+    *revision_code = strtoul(cache, &end, 16);
+
+    return end != cache && *end == '\n';
+}
+
+static void write_cache(unsigned int revision_code)
+{
+    char cache[MAX_LINE_LENGTH];
+    char temporary_path[MAX_LINE_LENGTH];
+    int length;
+    int cache_file;
+
+    length = snprintf(cache, sizeof(cache), "%08x\n", revision_code);
+    snprintf(temporary_path, sizeof(temporary_path), PROBE_CACHE_FILE ".%d", (int) getpid());
+
+    cache_file = open(temporary_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, PROBE_CACHE_MODE);
+
+    if(cache_file < 0)
+    {
+        return;
+    }
+
+    if(write(cache_file, cache, length) != length || close(cache_file) != 0 || 
+       rename(temporary_path, PROBE_CACHE_FILE) != 0)
+    {
+        unlink(temporary_path);
+    }
+}
+
+static bool read_device_tree(unsigned int* revision_code)
+{
+    unsigned char code[4];
+    int device_tree_file;
+    ssize_t length;
+
+    device_tree_file = open(DEVICE_TREE_REVISION_PATH, O_RDONLY | O_CLOEXEC);
+
+    if(device_tree_file < 0)
+    {
+        return false;
+    }
+
+    length = read(device_tree_file, code, sizeof(code));
+    close(device_tree_file);
+
+    if(length != sizeof(code))
+    {
+        return false;
+    }
+
+    *revision_code = ((unsigned int) code[0] << 24) | (code[1] << 16) | (code[2] << 8) | code[3];
+
+    return true;
+}
+
+static bool read_cpu_info(unsigned int* revision_code)
+{
+    FILE* cpu_info_file;
+    char cpu_info_stream[MAX_LINE_LENGTH];
+    char* value;
+    bool found = false;
+
+    cpu_info_file = fopen(CPU_INFO_PATH, "r");
+
+    if(!cpu_info_file)
+    {
+        return false;
+    }
+
+    while(fgets(cpu_info_stream, MAX_LINE_LENGTH, cpu_info_file))
+    {
+        if(strncmp(cpu_info_stream, REVISION_HEADER, strlen(REVISION_HEADER)) != 0)
+        {
+            continue;
+        }
+
+        value = strchr(cpu_info_stream, ':');
+
+        if(value != 0x00)
+        {
+            *revision_code = strtoul(value + 1, 0x00, 16);
+            found = true;
+        }
+
+        break;
+    }
+
+    fclose(cpu_info_file);
+
+    return found;
+}
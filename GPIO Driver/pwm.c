@@ -0,0 +1,485 @@
+/*
+ * File:        pwm.c
+ * Description: Hardware PWM and general purpose clock outputs programmed through the PWM and clock manager registers.
+ * Programmer:  tnewman
+ * Date:        Oct 16, 2026
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 Thomas Newman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+#include "pwm.h"
+#include "internal.h"
+
+#include <pthread.h>
+#include <stdint.h>
+
+/*
+ * Configuration
+ */
+#define PWM_CHANNEL_COUNT 2
+#define CLOCK_CHANNEL_COUNT 3
+
+/*
+ * Name: PeripheralPin
+ * Description: A Broadcom pin that can be routed to a channel of a peripheral.
+ */
+typedef struct {
+    int broadcom_number;
+    int channel;
+    PinMode pin_mode;
+} PeripheralPin;
+
+/*
+ * Name: ClockSources
+ * Description: Frequencies of the clock sources of a chip.
+ */
+typedef struct {
+    uint32_t peripheral_base;
+    unsigned int oscillator_frequency;
+    unsigned int plld_frequency;
+} ClockSources;
+
+/*
+ * Routing Tables
+ */
+const PeripheralPin PWM_PINS[] = {{12, 0, MODE_ALT0}, {13, 1, MODE_ALT0}, {18, 0, MODE_ALT5}, {19, 1, MODE_ALT5}, 
+        {40, 0, MODE_ALT0}, {41, 1, MODE_ALT0}, {45, 1, MODE_ALT0}};
+const PeripheralPin CLOCK_PINS[] = {{4, 0, MODE_ALT0}, {5, 1, MODE_ALT0}, {6, 2, MODE_ALT0}, {20, 0, MODE_ALT5}, 
+        {21, 1, MODE_ALT5}, {32, 0, MODE_ALT0}, {34, 0, MODE_ALT0}, {42, 1, MODE_ALT0}, {43, 2, MODE_ALT0}, 
+        {44, 1, MODE_ALT0}};
+
+// Registers of each channel
+const unsigned int PWM_RANGE_REGISTERS[PWM_CHANNEL_COUNT] = {PWM_RNG1, PWM_RNG2};
+const unsigned int PWM_DATA_REGISTERS[PWM_CHANNEL_COUNT] = {PWM_DAT1, PWM_DAT2};
+const unsigned int CLOCK_CONTROL_REGISTERS[CLOCK_CHANNEL_COUNT] = {CM_GP0CTL, CM_GP1CTL, CM_GP2CTL};
+const unsigned int CLOCK_DIVISOR_REGISTERS[CLOCK_CHANNEL_COUNT] = {CM_GP0DIV, CM_GP1DIV, CM_GP2DIV};
+
+// Clock sources of each chip (the BCM2837 shares the peripheral base and clocks of the BCM2836)
+const ClockSources CLOCK_SOURCES[] = {{BCM2835_PERIPHERAL_BASE, 19200000, 500000000}, 
+        {BCM2836_PERIPHERAL_BASE, 19200000, 500000000}, {BCM2711_PERIPHERAL_BASE, 54000000, 750000000}};
+
+/*
+ * Global Variables
+ */
+pthread_mutex_t peripheral_lock = PTHREAD_MUTEX_INITIALIZER; // Serializes PWM and clock manager programming
+
+/*
+ * Implementation Functions
+ *
+ * These functions are for internal use only.
+ */
+
+/*
+ * Name: find_peripheral_pin
+ * Description: Finds the channel and alternate function of a pin in a routing table.
+ * Parameters:
+ *       pin_number[in] - The GPIO pin number.
+ *       pin_type[in] - The numbering convention used to identify the GPIO pin.
+ *       pins[in] - The routing table.
+ *       pin_count[in] - Number of entries in the routing table.
+ *       peripheral_pin[out] - The routing of the pin.
+ * Returns: Result of the operation.
+ */
+static StatusCode find_peripheral_pin(int pin_number, PinType pin_type, const PeripheralPin* pins, int pin_count, 
+        PeripheralPin* peripheral_pin);
+
+/*
+ * Name: find_clock_sources
+ * Description: Finds the clock source frequencies of the current chip.
+ * Parameters: None
+ * Returns: The clock sources, or 0x00 if the chip is not known.
+ */
+static const ClockSources* find_clock_sources();
+
+/*
+ * Name: pwm_register
+ * Description: Gets a mapped PWM register.
+ * Parameters:
+ *       register_address[in] - Address of the register.
+ * Returns: The mapped register.
+ */
+static volatile Register_Type* pwm_register(unsigned int register_address);
+
+/*
+ * Name: clock_register
+ * Description: Gets a mapped clock manager register.
+ * Parameters:
+ *       register_address[in] - Address of the register.
+ * Returns: The mapped register.
+ */
+static volatile Register_Type* clock_register(unsigned int register_address);
+
+/*
+ * Name: start_clock
+ * Description: Stops a clock, programs its divisor, and starts it again.
+ * Parameters:
+ *       control_address[in] - Address of the control register of the clock.
+ *       divisor_address[in] - Address of the divisor register of the clock.
+ *       source[in] - The clock source.
+ *       divisor[in] - The divisor in 1/4096ths (integer part and fractional part of the divisor register).
+ * Returns: None
+ */
+static void start_clock(unsigned int control_address, unsigned int divisor_address, unsigned int source, 
+        unsigned int divisor);
+
+/*
+ * Name: stop_clock
+ * Description: Disables a clock and waits for it to stop at the end of its cycle. A clock that does not stop within 
+ *              CLOCK_BUSY_SPINS reads is killed.
+ * Parameters:
+ *       control_address[in] - Address of the control register of the clock.
+ * Returns: None
+ */
+static void stop_clock(unsigned int control_address);
+
+/*
+ * Name: release_pin
+ * Description: Clears a pin and switches it back to output mode, in that order, so the pin does not pulse high.
+ * Parameters:
+ *       broadcom_number[in] - The Broadcom pin.
+ * Returns: Result of the operation.
+ */
+static StatusCode release_pin(int broadcom_number);
+
+StatusCode set_gpio_hardware_pwm(int pin_number, PinType pin_type, unsigned int frequency, unsigned int duty)
+{
+    PeripheralPin pwm_pin;
+    const ClockSources* clock_sources;
+    StatusCode status;
+    unsigned int range;
+    unsigned int data;
+    unsigned int channel_bits;
+    unsigned int control;
+
+    status = find_peripheral_pin(pin_number, pin_type, PWM_PINS, sizeof(PWM_PINS) / sizeof(PeripheralPin), &pwm_pin);
+
+    if(status != SUCCESS)
+    {
+        return status;
+    }
+
+    clock_sources = find_clock_sources();
+
+    if(peripheral_memory[PWM_REGION] == 0x00 || peripheral_memory[CLOCK_REGION] == 0x00 || clock_sources == 0x00)
+    {
+        return UNSUPPORTED;
+    }
+
+    // The period is a whole number of PWM clock cycles, and a period needs at least two to be high and low
+    if(frequency == 0 || frequency > clock_sources->oscillator_frequency / PWM_CLOCK_DIVISOR / 2)
+    {
+        return UNSUPPORTED;
+    }
+
+    range = (clock_sources->oscillator_frequency / PWM_CLOCK_DIVISOR + frequency / 2) / frequency;
+
+    if(duty > HARDWARE_PWM_DUTY_SCALE)
+    {
+        duty = HARDWARE_PWM_DUTY_SCALE;
+    }
+
+    data = (unsigned int) (((uint64_t) range * duty + HARDWARE_PWM_DUTY_SCALE / 2) / HARDWARE_PWM_DUTY_SCALE);
+    channel_bits = (PWM_PWEN1 | PWM_MSEN1) << (pwm_pin.channel * PWM_CHANNEL_SHIFT);
+
+    pthread_mutex_lock(&peripheral_lock);
+    start_pwm_clock();
+    control = *pwm_register(PWM_CTL);
+
+    if((control & channel_bits) == channel_bits && *pwm_register(PWM_RANGE_REGISTERS[pwm_pin.channel]) == range)
+    {
+        // Only the duty cycle changes, and the channel picks it up at the start of the next period
+        *pwm_register(PWM_DATA_REGISTERS[pwm_pin.channel]) = data;
+    }
+    else
+    {
+        *pwm_register(PWM_CTL) = control & ~(PWM_CHANNEL_BITS << (pwm_pin.channel * PWM_CHANNEL_SHIFT));
+        *pwm_register(PWM_RANGE_REGISTERS[pwm_pin.channel]) = range;
+        *pwm_register(PWM_DATA_REGISTERS[pwm_pin.channel]) = data;
+        *pwm_register(PWM_CTL) = (control & ~(PWM_CHANNEL_BITS << (pwm_pin.channel * PWM_CHANNEL_SHIFT))) | 
+                channel_bits;
+    }
+
+    pthread_mutex_unlock(&peripheral_lock);
+
+    // The pin is routed last, so it never shows the channel before it is programmed
+    if(!set_gpio_pin_function(pwm_pin.broadcom_number, pwm_pin.pin_mode))
+    {
+        return REGISTER_FAILURE;
+    }
+
+    return SUCCESS;
+}
+
+StatusCode stop_gpio_hardware_pwm(int pin_number, PinType pin_type)
+{
+    PeripheralPin pwm_pin;
+    StatusCode status;
+
+    status = find_peripheral_pin(pin_number, pin_type, PWM_PINS, sizeof(PWM_PINS) / sizeof(PeripheralPin), &pwm_pin);
+
+    if(status != SUCCESS)
+    {
+        return status;
+    }
+
+    if(peripheral_memory[PWM_REGION] == 0x00)
+    {
+        return UNSUPPORTED;
+    }
+
+    status = release_pin(pwm_pin.broadcom_number);
+
+    pthread_mutex_lock(&peripheral_lock);
+    *pwm_register(PWM_CTL) &= ~(PWM_PWEN1 << (pwm_pin.channel * PWM_CHANNEL_SHIFT));
+    pthread_mutex_unlock(&peripheral_lock);
+
+    return status;
+}
+
+StatusCode start_gpio_clock(int pin_number, PinType pin_type, unsigned int frequency)
+{
+    PeripheralPin clock_pin;
+    const ClockSources* clock_sources;
+    StatusCode status;
+    unsigned int sources[2];
+    unsigned int source_frequencies[2];
+    uint64_t divisor;
+    int source;
+    int exact;
+
+    status = find_peripheral_pin(pin_number, pin_type, CLOCK_PINS, sizeof(CLOCK_PINS) / sizeof(PeripheralPin), 
+            &clock_pin);
+
+    if(status != SUCCESS)
+    {
+        return status;
+    }
+
+    clock_sources = find_clock_sources();
+
+    if(peripheral_memory[CLOCK_REGION] == 0x00 || clock_sources == 0x00 || frequency == 0)
+    {
+        return UNSUPPORTED;
+    }
+
+    // The oscillator has less jitter than PLLD, so it is tried first
+    sources[0] = CM_SRC_OSCILLATOR;
+    source_frequencies[0] = clock_sources->oscillator_frequency;
+    sources[1] = CM_SRC_PLLD;
+    source_frequencies[1] = clock_sources->plld_frequency;
+
+    for(exact = 1; exact >= 0; exact--)
+    {
+        for(source = 0; source < 2; source++)
+        {
+            divisor = (((uint64_t) source_frequencies[source] << CM_DIVF_BITS) + frequency / 2) / frequency;
+
+            if(exact && (divisor & CM_DIVF_MAX) != 0)
+            {
+                continue;
+            }
+
+            // The fractional divider needs an integer part of at least 2
+            if(divisor >> CM_DIVF_BITS < ((divisor & CM_DIVF_MAX) == 0 ? 1 : 2) || 
+                    divisor >> CM_DIVF_BITS > CM_DIVI_MAX)
+            {
+                continue;
+            }
+
+            pthread_mutex_lock(&peripheral_lock);
+            start_clock(CLOCK_CONTROL_REGISTERS[clock_pin.channel], CLOCK_DIVISOR_REGISTERS[clock_pin.channel], 
+                    sources[source], (unsigned int) divisor);
+            pthread_mutex_unlock(&peripheral_lock);
+
+            if(!set_gpio_pin_function(clock_pin.broadcom_number, clock_pin.pin_mode))
+            {
+                return REGISTER_FAILURE;
+            }
+
+            return SUCCESS;
+        }
+    }
+
+    return UNSUPPORTED;
+}
+
+StatusCode stop_gpio_clock(int pin_number, PinType pin_type)
+{
+    PeripheralPin clock_pin;
+    StatusCode status;
+
+    status = find_peripheral_pin(pin_number, pin_type, CLOCK_PINS, sizeof(CLOCK_PINS) / sizeof(PeripheralPin), 
+            &clock_pin);
+
+    if(status != SUCCESS)
+    {
+        return status;
+    }
+
+    if(peripheral_memory[CLOCK_REGION] == 0x00)
+    {
+        return UNSUPPORTED;
+    }
+
+    status = release_pin(clock_pin.broadcom_number);
+
+    pthread_mutex_lock(&peripheral_lock);
+    stop_clock(CLOCK_CONTROL_REGISTERS[clock_pin.channel]);
+    pthread_mutex_unlock(&peripheral_lock);
+
+    return status;
+}
+
+unsigned int start_pwm_clock()
+{
+    const ClockSources* clock_sources;
+    unsigned int control;
+
+    clock_sources = find_clock_sources();
+
+    if(clock_sources == 0x00)
+    {
+        return 0;
+    }
+
+    // The PWM clock is shared by both channels (and DMA pacing), so it is only programmed when it is not running
+    if((*clock_register(CM_PWMCTL) & (CM_ENAB | CM_SRC_BITS)) != (CM_ENAB | CM_SRC_OSCILLATOR) || 
+            (*clock_register(CM_PWMDIV) >> CM_DIVI_SHIFT & CM_DIVI_MAX) != PWM_CLOCK_DIVISOR)
+    {
+        control = *pwm_register(PWM_CTL);
+        *pwm_register(PWM_CTL) = control & ~((PWM_PWEN1 << PWM_CHANNEL_SHIFT) | PWM_PWEN1);
+        start_clock(CM_PWMCTL, CM_PWMDIV, CM_SRC_OSCILLATOR, PWM_CLOCK_DIVISOR << CM_DIVF_BITS);
+        *pwm_register(PWM_CTL) = control;
+    }
+
+    return clock_sources->oscillator_frequency / PWM_CLOCK_DIVISOR;
+}
+
+static StatusCode find_peripheral_pin(int pin_number, PinType pin_type, const PeripheralPin* pins, int pin_count, 
+        PeripheralPin* peripheral_pin)
+{
+    int broadcom_number;
+    int pin;
+
+    if(!check_init())
+    {
+        return NO_INIT;
+    }
+
+    if(!pin_to_broadcom(pin_number, pin_type, &broadcom_number))
+    {
+        return INVALID_PIN;
+    }
+
+    for(pin = 0; pin < pin_count; pin++)
+    {
+        if(pins[pin].broadcom_number == broadcom_number)
+        {
+            *peripheral_pin = pins[pin];
+            return SUCCESS;
+        }
+    }
+
+    // The pin exists, but it cannot be routed to this peripheral
+    return UNSUPPORTED;
+}
+
+static const ClockSources* find_clock_sources()
+{
+    int chip;
+
+    for(chip = 0; chip < (int) (sizeof(CLOCK_SOURCES) / sizeof(ClockSources)); chip++)
+    {
+        if(CLOCK_SOURCES[chip].peripheral_base == peripheral_base)
+        {
+            return &CLOCK_SOURCES[chip];
+        }
+    }
+
+    return 0x00;
+}
+
+static volatile Register_Type* pwm_register(unsigned int register_address)
+{
+    return peripheral_memory[PWM_REGION] + calculate_region_offset(register_address, PWM_MEMORY_START);
+}
+
+static volatile Register_Type* clock_register(unsigned int register_address)
+{
+    return peripheral_memory[CLOCK_REGION] + calculate_region_offset(register_address, CM_MEMORY_START);
+}
+
+static void start_clock(unsigned int control_address, unsigned int divisor_address, unsigned int source, 
+        unsigned int divisor)
+{
+    unsigned int mash;
+
+    // A divisor with a fractional part needs the first order noise shaper
+    mash = (divisor & CM_DIVF_MAX) == 0 ? 0 : 1;
+
+    // The divisor and source may only change while the clock is stopped
+    stop_clock(control_address);
+    *clock_register(divisor_address) = CM_PASSWORD | divisor;
+    *clock_register(control_address) = CM_PASSWORD | mash << CM_MASH_SHIFT | source;
+    *clock_register(control_address) = CM_PASSWORD | mash << CM_MASH_SHIFT | source | CM_ENAB;
+}
+
+static void stop_clock(unsigned int control_address)
+{
+    volatile Register_Type* control;
+    int spins;
+
+    control = clock_register(control_address);
+    *control = CM_PASSWORD | (*control & CM_SRC_BITS);
+
+    for(spins = 0; (*control & CM_BUSY) != 0 && spins < CLOCK_BUSY_SPINS; spins++)
+    {
+    }
+
+    if((*control & CM_BUSY) != 0)
+    {
+        *control = CM_PASSWORD | CM_KILL;
+
+        while((*control & CM_BUSY) != 0)
+        {
+        }
+
+        *control = CM_PASSWORD;
+    }
+}
+
+static StatusCode release_pin(int broadcom_number)
+{
+    *(gpio_memory + calculate_offset(broadcom_number < REGISTER_SIZE ? GPCLR0 : GPCLR1)) = 
+            GPCLR_BITS << (broadcom_number % REGISTER_SIZE);
+
+    if(!set_gpio_pin_function(broadcom_number, GPIO_OUTPUT))
+    {
+        return REGISTER_FAILURE;
+    }
+
+    return SUCCESS;
+}
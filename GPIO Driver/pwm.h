@@ -0,0 +1,108 @@
+/*
+ * File:        pwm.h
+ * Description: Hardware PWM and general purpose clock outputs.
+ * Programmer:  tnewman
+ * Date:        Oct 16, 2026
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 Thomas Newman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+#ifndef PWM_H
+#define PWM_H
+
+#include "gpio.h"
+
+/*
+ * Configuration
+ */
+#define HARDWARE_PWM_DUTY_SCALE 1000000 // Duty cycles are given in millionths of the period
+#define PWM_CLOCK_DIVISOR 2 // The PWM clock is the oscillator divided by this, whatever the PWM frequency
+#define CLOCK_BUSY_SPINS 100000 // Reads of a clock control register before a clock that will not stop is killed
+
+/*
+ * Pin Routing
+ *
+ * PWM channel 0 is on GPIO12 and GPIO40 (ALT0) and GPIO18 (ALT5). PWM channel 1 is on GPIO13, GPIO41, and GPIO45 
+ * (ALT0) and GPIO19 (ALT5). GPCLK0 is on GPIO4, GPIO32, and GPIO34 (ALT0) and GPIO20 (ALT5). GPCLK1 is on GPIO5, 
+ * GPIO42, and GPIO44 (ALT0) and GPIO21 (ALT5). GPCLK2 is on GPIO6 and GPIO43 (ALT0). Pins on the same channel show 
+ * the same signal.
+ */
+
+/*
+ * Name: set_gpio_hardware_pwm
+ * Description: Starts the PWM channel of a pin, or changes its frequency and duty cycle, and routes the pin to it. The 
+ *              channel runs in mark-space mode from the PWM clock, which is only programmed the first time, so both 
+ *              channels can run at different frequencies. When only the duty cycle changes, only the data register 
+ *              is written and the new duty cycle starts with the next period.
+ * Note: Needs the PWM and clock manager registers, which are mapped by MEMORY_BACKEND and SIMULATED_BACKEND.
+ * Parameters:
+ *       pin_number[in] - The GPIO pin number.
+ *       pin_type[in] - The numbering convention used to identify the GPIO pin.
+ *       frequency[in] - Frequency in Hz. It is rounded to the nearest division of the PWM clock.
+ *       duty[in] - Duty cycle in millionths of the period. Values at or above HARDWARE_PWM_DUTY_SCALE keep the pin 
+ *                  high.
+ * Returns: Result of the operation (UNSUPPORTED if the pin has no PWM channel, the registers are not mapped, or the 
+ *          frequency is out of range).
+ */
+StatusCode set_gpio_hardware_pwm(int pin_number, PinType pin_type, unsigned int frequency, unsigned int duty);
+
+/*
+ * Name: stop_gpio_hardware_pwm
+ * Description: Switches a pin back to a cleared output and stops its PWM channel.
+ * Parameters:
+ *       pin_number[in] - The GPIO pin number.
+ *       pin_type[in] - The numbering convention used to identify the GPIO pin.
+ * Returns: Result of the operation.
+ */
+StatusCode stop_gpio_hardware_pwm(int pin_number, PinType pin_type);
+
+/*
+ * Name: start_gpio_clock
+ * Description: Starts the general purpose clock of a pin and routes the pin to it. The clock runs from the 
+ *              oscillator or from PLLD, preferring a source that divides down to the frequency exactly (a plain 
+ *              square wave). Otherwise the fractional divider is used, which adds jitter but keeps the average 
+ *              frequency.
+ * Note: Needs the clock manager registers, which are mapped by MEMORY_BACKEND and SIMULATED_BACKEND.
+ * Parameters:
+ *       pin_number[in] - The GPIO pin number.
+ *       pin_type[in] - The numbering convention used to identify the GPIO pin.
+ *       frequency[in] - Frequency in Hz.
+ * Returns: Result of the operation (UNSUPPORTED if the pin has no general purpose clock, the registers are not 
+ *          mapped, or no source can be divided down to the frequency).
+ */
+StatusCode start_gpio_clock(int pin_number, PinType pin_type, unsigned int frequency);
+
+/*
+ * Name: stop_gpio_clock
+ * Description: Switches a pin back to a cleared output and stops its general purpose clock.
+ * Parameters:
+ *       pin_number[in] - The GPIO pin number.
+ *       pin_type[in] - The numbering convention used to identify the GPIO pin.
+ * Returns: Result of the operation.
+ */
+StatusCode stop_gpio_clock(int pin_number, PinType pin_type);
+
+#endif /* PWM_H_ */
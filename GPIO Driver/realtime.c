@@ -0,0 +1,140 @@
+/*
+ * File:        realtime.c
+ * Description: Real-time thread preparation implementation.
+ * Programmer:  tnewman
+ * Date:        Oct 16, 2026
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 Thomas Newman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#define _GNU_SOURCE
+
+#include "realtime.h"
+
+#include <errno.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/*
+ * Implementation Functions
+ *
+ * These functions are for internal use only.
+ */
+
+/*
+ * Name: prefault_stack
+ * Description: Writes to a block of stack, so the pages are mapped before the timing-critical code needs them.
+ * Parameters:
+ *       size[in] - Bytes of stack to touch.
+ * Returns: None
+ */
+static void __attribute__((noinline)) prefault_stack(size_t size);
+
+/*
+ * Name: error_to_status
+ * Description: Converts an errno value from a failed step into a StatusCode.
+ * Parameters:
+ *       error[in] - The errno value.
+ * Returns: NOT_ROOT for permission and memory lock limit errors, otherwise UNSUPPORTED.
+ */
+static StatusCode error_to_status(int error);
+
+StatusCode prepare_realtime_thread(int cpu, int priority, size_t stack_prefault)
+{
+    struct sched_param parameters;
+    cpu_set_t cpu_set;
+    StatusCode status = SUCCESS;
+    int error;
+
+    // Memory
+    if(mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+    {
+        status = error_to_status(errno);
+    }
+
+    mallopt(M_TRIM_THRESHOLD, -1);
+    mallopt(M_MMAP_MAX, 0);
+
+    if(stack_prefault > 0)
+    {
+        prefault_stack(stack_prefault);
+    }
+
+    // Affinity
+    if(cpu >= 0)
+    {
+        if(cpu >= CPU_SETSIZE)
+        {
+            error = EINVAL;
+        }
+        else
+        {
+            CPU_ZERO(&cpu_set);
+            CPU_SET(cpu, &cpu_set);
+            error = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+        }
+
+        if(error != 0 && status == SUCCESS)
+        {
+            status = error_to_status(error);
+        }
+    }
+
+    // Scheduling
+    if(priority > 0)
+    {
+        memset(&parameters, 0x00, sizeof(parameters));
+        parameters.sched_priority = priority;
+        error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &parameters);
+
+        if(error != 0 && status == SUCCESS)
+        {
+            status = error_to_status(error);
+        }
+    }
+
+    return status;
+}
+
+static void prefault_stack(size_t size)
+{
+    volatile unsigned char* stack = __builtin_alloca(size);
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    size_t i;
+
+    for(i = 0; i < size; i += page_size)
+    {
+        stack[i] = 0x00;
+    }
+}
+
+static StatusCode error_to_status(int error)
+{
+    return error == EPERM || error == EACCES || error == ENOMEM ? NOT_ROOT : UNSUPPORTED;
+}
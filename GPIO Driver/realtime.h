@@ -0,0 +1,64 @@
+/*
+ * File:        realtime.h
+ * Description: Definition of the helper that prepares a thread for timing-critical GPIO work.
+ * Programmer:  tnewman
+ * Date:        Oct 16, 2026
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 Thomas Newman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef REALTIME_H
+#define REALTIME_H
+
+#include "gpio.h"
+
+#include <stddef.h>
+
+/*
+ * Configuration
+ */
+#define REALTIME_STACK_PREFAULT (256 * 1024)
+
+/*
+ * Name: prepare_realtime_thread
+ * Description: Prepares the calling thread for timing-critical GPIO work, so page faults and the scheduler do not 
+ *              interrupt it:
+ *              - Locks every current and future page of the process in memory and stops malloc from returning 
+ *                memory to the system (or taking new memory with mmap), so allocations do not fault later.
+ *              - Touches stack_prefault bytes of the thread's stack, so its pages are resident.
+ *              - Pins the thread to a CPU (isolate it with isolcpus for the best results).
+ *              - Switches the thread to SCHED_FIFO at a priority.
+ *              Every step is attempted even if an earlier one fails.
+ * Note: Locking memory and SCHED_FIFO need root, CAP_IPC_LOCK and CAP_SYS_NICE, or matching rlimits.
+ * Parameters:
+ *       cpu[in] - The CPU to run the thread on, or a negative number to leave the affinity unchanged.
+ *       priority[in] - The SCHED_FIFO priority (1 to 99), or 0 to leave the scheduling policy unchanged.
+ *       stack_prefault[in] - Bytes of stack to touch (for example REALTIME_STACK_PREFAULT), or 0 to skip.
+ * Returns: Result of the first step that failed. NOT_ROOT if a step was not permitted, UNSUPPORTED if the CPU or 
+ *          priority is invalid.
+ */
+StatusCode prepare_realtime_thread(int cpu, int priority, size_t stack_prefault);
+
+#endif /* REALTIME_H_ */
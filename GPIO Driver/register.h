@@ -42,9 +42,15 @@ typedef volatile unsigned int Register_Type;
 
 // GPIO Memory Region
 #define GPIO_MEMORY_START 0x20200000
-#define GPIO_MEMORY_END 0x202000B0
+#define GPIO_MEMORY_END 0x202000F4
 #define GPIO_MEMORY_SIZE (GPIO_MEMORY_END - GPIO_MEMORY_START)
 
+// Peripheral Base Addresses (the peripherals are at the same offsets from the base on every chip)
+#define BCM2835_PERIPHERAL_BASE 0x20000000
+#define BCM2836_PERIPHERAL_BASE 0x3F000000
+#define BCM2711_PERIPHERAL_BASE 0xFE000000
+#define GPIO_PERIPHERAL_OFFSET (GPIO_MEMORY_START - BCM2835_PERIPHERAL_BASE)
+
 // GPIO Function Select Registers
 #define GPFSEL0 0x20200000
 #define GPFSEL1 0x20200004
@@ -53,6 +59,8 @@ typedef volatile unsigned int Register_Type;
 #define GPFSEL4 0x20200010
 #define GPFSEL5 0x20200014
 #define GPFSEL_BITS_PER_PIN 3
+#define GPFSEL_BITS 0x07
+#define GPFSEL_REGISTER_COUNT 6
 
 // GPIO Functions
 #define GPIO_INPUT 0x00
@@ -81,10 +89,189 @@ typedef volatile unsigned int Register_Type;
 #define GPLEV1 0x20200038
 #define GPLEV_BITS_PER_PIN 1
 
+// GPIO Event Detect Status Registers (write 1 to clear)
+#define GPEDS0 0x20200040
+#define GPEDS1 0x20200044
+
+// GPIO Rising Edge Detect Enable Registers
+#define GPREN0 0x2020004C
+#define GPREN1 0x20200050
+
+// GPIO Falling Edge Detect Enable Registers
+#define GPFEN0 0x20200058
+#define GPFEN1 0x2020005C
+
+// GPIO High Detect Enable Registers
+#define GPHEN0 0x20200064
+#define GPHEN1 0x20200068
+
+// GPIO Low Detect Enable Registers
+#define GPLEN0 0x20200070
+#define GPLEN1 0x20200074
+
+// GPIO Asynchronous Rising Edge Detect Enable Registers
+#define GPAREN0 0x2020007C
+#define GPAREN1 0x20200080
+
+// GPIO Asynchronous Falling Edge Detect Enable Registers
+#define GPAFEN0 0x20200088
+#define GPAFEN1 0x2020008C
+
+// GPIO Pull-up/down Register (BCM2835 to BCM2837)
+#define GPPUD 0x20200094
+
+// GPIO Pull-up/down Clock Registers (BCM2835 to BCM2837)
+#define GPPUDCLK0 0x20200098
+#define GPPUDCLK1 0x2020009C
+
+// GPIO Pull-up/down Control Registers (BCM2711)
+#define GPIO_PUP_PDN_CNTRL_REG0 0x202000E4
+#define GPIO_PUP_PDN_CNTRL_REG1 0x202000E8
+#define GPIO_PUP_PDN_CNTRL_REG2 0x202000EC
+#define GPIO_PUP_PDN_CNTRL_REG3 0x202000F0
+#define GPIO_PUP_PDN_BITS_PER_PIN 2
+#define GPIO_PUP_PDN_BITS 0x03
+#define GPIO_PUP_PDN_NONE 0x00
+#define GPIO_PUP_PDN_UP 0x01
+#define GPIO_PUP_PDN_DOWN 0x02
+
+// Clock Manager Memory Region
+#define CM_MEMORY_START 0x20101000
+#define CM_MEMORY_END 0x201010A8
+#define CM_MEMORY_SIZE (CM_MEMORY_END - CM_MEMORY_START)
+
+// Clock Manager General Purpose Clock Registers
+#define CM_GP0CTL 0x20101070
+#define CM_GP0DIV 0x20101074
+#define CM_GP1CTL 0x20101078
+#define CM_GP1DIV 0x2010107C
+#define CM_GP2CTL 0x20101080
+#define CM_GP2DIV 0x20101084
+
+// Clock Manager PWM Clock Registers
+#define CM_PWMCTL 0x201010A0
+#define CM_PWMDIV 0x201010A4
+
+// Clock Manager Register Fields (every write must carry the password)
+#define CM_PASSWORD 0x5A000000
+#define CM_SRC_OSCILLATOR 0x01
+#define CM_SRC_PLLD 0x06
+#define CM_SRC_BITS 0x0F
+#define CM_ENAB 0x10
+#define CM_KILL 0x20
+#define CM_BUSY 0x80
+#define CM_MASH_SHIFT 9
+#define CM_DIVI_SHIFT 12
+#define CM_DIVI_MAX 0xFFF
+#define CM_DIVF_BITS 12
+#define CM_DIVF_MAX 0xFFF
+
+// PWM Memory Region
+#define PWM_MEMORY_START 0x2020C000
+#define PWM_MEMORY_END 0x2020C028
+#define PWM_MEMORY_SIZE (PWM_MEMORY_END - PWM_MEMORY_START)
+
+// PWM Registers
+#define PWM_CTL 0x2020C000
+#define PWM_STA 0x2020C004
+#define PWM_DMAC 0x2020C008
+#define PWM_RNG1 0x2020C010
+#define PWM_DAT1 0x2020C014
+#define PWM_FIF1 0x2020C018
+#define PWM_RNG2 0x2020C020
+#define PWM_DAT2 0x2020C024
+
+// PWM Control Register Fields (the channel 2 bits are the channel 1 bits shifted by PWM_CHANNEL_SHIFT, except the
+// FIFO clear bit, which is shared)
+#define PWM_PWEN1 0x01
+#define PWM_MODE1 0x02
+#define PWM_RPTL1 0x04
+#define PWM_SBIT1 0x08
+#define PWM_POLA1 0x10
+#define PWM_USEF1 0x20
+#define PWM_CLRF 0x40
+#define PWM_MSEN1 0x80
+#define PWM_CHANNEL_SHIFT 8
+#define PWM_CHANNEL_BITS 0xFF
+
+// PWM DMA Configuration Register Fields
+#define PWM_DMAC_ENAB 0x80000000
+#define PWM_DMAC_PANIC_SHIFT 8
+#define PWM_DMAC_DREQ_SHIFT 0
+
+// DMA Memory Region (channels 0 to 14, DMA_CHANNEL_STRIDE apart, then the global enable register)
+#define DMA_MEMORY_START 0x20007000
+#define DMA_MEMORY_END 0x20007FF4
+#define DMA_MEMORY_SIZE (DMA_MEMORY_END - DMA_MEMORY_START)
+#define DMA_CHANNEL_STRIDE 0x100
+#define DMA_CHANNEL_COUNT 15
+#define DMA4_FIRST_CHANNEL 11 // The BCM2711 has a different kind of engine from this channel on
+
+// DMA Channel Registers (of channel 0)
+#define DMA_CS 0x20007000
+#define DMA_CONBLK_AD 0x20007004
+#define DMA_DEBUG 0x20007020
+#define DMA_DEBUG_ERRORS 0x07 // Write to clear the error flags
+
+// DMA Global Enable Register
+#define DMA_ENABLE 0x20007FF0
+
+// DMA Control and Status Register Fields
+#define DMA_CS_ACTIVE 0x01
+#define DMA_CS_END 0x02
+#define DMA_CS_INT 0x04
+#define DMA_CS_ERROR 0x100
+#define DMA_CS_PRIORITY_SHIFT 16
+#define DMA_CS_PANIC_PRIORITY_SHIFT 20
+#define DMA_CS_WAIT_FOR_OUTSTANDING_WRITES 0x10000000
+#define DMA_CS_ABORT 0x40000000
+#define DMA_CS_RESET 0x80000000
+
+// DMA Transfer Information Fields
+#define DMA_TI_WAIT_RESP 0x08
+#define DMA_TI_DEST_INC 0x10
+#define DMA_TI_DEST_DREQ 0x40
+#define DMA_TI_SRC_INC 0x100
+#define DMA_TI_PERMAP_SHIFT 16
+#define DMA_TI_PERMAP_BITS 0x1F
+#define DMA_TI_NO_WIDE_BURSTS 0x04000000
+#define DMA_DREQ_PWM 5
+
+// System Timer Memory Region
+#define TIMER_MEMORY_START 0x20003000
+#define TIMER_MEMORY_END 0x2000301C
+#define TIMER_MEMORY_SIZE (TIMER_MEMORY_END - TIMER_MEMORY_START)
+
+// System Timer Registers (a free running 1 MHz counter and its compare registers)
+#define TIMER_CS 0x20003000
+#define TIMER_CLO 0x20003004
+#define TIMER_CHI 0x20003008
+#define TIMER_C0 0x2000300C
+#define TIMER_C1 0x20003010
+#define TIMER_C2 0x20003014
+#define TIMER_C3 0x20003018
+#define TIMER_FREQUENCY 1000000
+
+// Bus Addresses (as seen by the DMA engines)
+#define PERIPHERAL_BUS_BASE 0x7E000000
+#define BUS_ALIAS_BITS 0xC0000000
+
 // Calculate Offset of Current Register from Base Address
-inline Register_Type calculate_offset(Register_Type register_address)
+static inline unsigned int calculate_offset(unsigned int register_address)
 {
 	return (register_address - GPIO_MEMORY_START) / sizeof(Register_Type);
 }
 
+// Calculate Offset of a Register from the Start of its Peripheral Region
+static inline unsigned int calculate_region_offset(unsigned int register_address, unsigned int memory_start)
+{
+	return (register_address - memory_start) / sizeof(Register_Type);
+}
+
+// Calculate the Bus Address of a Register
+static inline unsigned int calculate_bus_address(unsigned int register_address)
+{
+	return register_address - BCM2835_PERIPHERAL_BASE + PERIPHERAL_BUS_BASE;
+}
+
 #endif /* REGISTER_H_ */
@@ -0,0 +1,370 @@
+/*
+ * File:        serial.c
+ * Description: Bit-banged serial (SPI and shift register) implementation.
+ * Programmer:  tnewman
+ * Date:        Oct 16, 2026
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 Thomas Newman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "serial.h"
+#include "internal.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+/*
+ * Configuration
+ */
+#define BITS_PER_BYTE 8
+
+/*
+ * Name: SerialBus
+ * Description: Register pointers of the bank holding the pins, the pin masks, and one mask table per data pin. 
+ *              bit_table[pin][value][bit] is the set mask of the data pin for bit number bit (in the order it is sent) 
+ *              of byte value. The clock is returned to idle in the same stores that present the data, so each bit 
+ *              costs three stores.
+ */
+struct SerialBus {
+    volatile Register_Type* set_register;
+    volatile Register_Type* clear_register;
+    volatile Register_Type* level_register;
+    volatile Register_Type* active_register; // Register that moves the clock to its active level
+    unsigned int idle_set_bits; // Clock bit if the clock idles high, otherwise 0x00
+    unsigned int idle_clear_bits; // Clock bit if the clock idles low, otherwise 0x00
+    unsigned int clock_bit;
+    unsigned int latch_bit;
+    unsigned int input_bit;
+    unsigned int data_bits;
+    LatchMode latch_mode;
+    bool lsb_first;
+    unsigned int clock_delay;
+    int data_pin_count;
+    unsigned int bit_table[][256][BITS_PER_BYTE];
+};
+
+/*
+ * Implementation Functions
+ *
+ * These functions are for internal use only.
+ */
+
+/*
+ * Name: serial_delay
+ * Description: Spins for a number of delay loop iterations.
+ * Parameters:
+ *       iterations[in] - Number of iterations to spin for.
+ * Returns: None
+ */
+static inline void serial_delay(unsigned int iterations)
+{
+    while(iterations-- > 0)
+    {
+        __asm__ volatile("");
+    }
+}
+
+/*
+ * Name: resolve_serial_pin
+ * Description: Converts an optional pin of a serial bus to its bit mask within the bus' bank.
+ * Parameters:
+ *       pin_number[in] - The pin, or SERIAL_NO_PIN.
+ *       pin_type[in] - The numbering convention used to identify the pin.
+ *       bank[in,out] - The bank of the bus, or -1 if no pin has been resolved yet.
+ *       pin_bit[out] - The bit of the pin within the bank, or 0x00 for SERIAL_NO_PIN.
+ * Returns: Result of the operation.
+ */
+static StatusCode resolve_serial_pin(int pin_number, PinType pin_type, int* bank, unsigned int* pin_bit);
+
+/*
+ * Name: begin_transfer
+ * Description: Selects the device if the latch pin is a chip select.
+ * Parameters:
+ *       serial_bus[in] - The open bus.
+ * Returns: None
+ */
+static void begin_transfer(SerialBus* serial_bus);
+
+/*
+ * Name: end_transfer
+ * Description: Returns the clock to idle and drives the latch pin.
+ * Parameters:
+ *       serial_bus[in] - The open bus.
+ * Returns: None
+ */
+static void end_transfer(SerialBus* serial_bus);
+
+StatusCode open_serial_bus(const SerialConfig* serial_config, SerialBus** serial_bus)
+{
+    SerialBus* bus;
+    StatusCode status;
+    unsigned int data_pin_bits[SERIAL_MAX_DATA_PINS];
+    int bank = -1;
+    int bank_shift;
+    int pin;
+    int value;
+    int bit;
+    int shift;
+
+    // Check initialization
+    if(!check_init())
+    {
+        return NO_INIT;
+    }
+
+    if(serial_config->data_pin_count < 1 || serial_config->data_pin_count > SERIAL_MAX_DATA_PINS)
+    {
+        return INVALID_PIN;
+    }
+
+    bus = malloc(sizeof(SerialBus) + serial_config->data_pin_count * sizeof(bus->bit_table[0]));
+
+    if(bus == 0x00)
+    {
+        return REGISTER_FAILURE;
+    }
+
+    // Validate every pin once and find the bank that holds them
+    status = resolve_serial_pin(serial_config->clock_pin, serial_config->pin_type, &bank, &bus->clock_bit);
+
+    if(status == SUCCESS)
+    {
+        status = resolve_serial_pin(serial_config->latch_pin, serial_config->pin_type, &bank, &bus->latch_bit);
+    }
+
+    if(status == SUCCESS)
+    {
+        status = resolve_serial_pin(serial_config->input_pin, serial_config->pin_type, &bank, &bus->input_bit);
+    }
+
+    bus->data_bits = 0x00;
+
+    for(pin = 0; pin < serial_config->data_pin_count && status == SUCCESS; pin++)
+    {
+        status = resolve_serial_pin(serial_config->data_pins[pin], serial_config->pin_type, &bank, &data_pin_bits[pin]);
+        bus->data_bits |= data_pin_bits[pin];
+    }
+
+    if(status == SUCCESS && bus->clock_bit == 0x00)
+    {
+        status = INVALID_PIN;
+    }
+
+    // Modes only change once every pin is known to be valid, so a rejected bus leaves all of its pins alone
+    if(status == SUCCESS)
+    {
+        bank_shift = bank * REGISTER_SIZE;
+
+        if(!set_gpio_mask_function((PinMask) (bus->clock_bit | bus->latch_bit | bus->data_bits) << bank_shift, 
+                GPIO_OUTPUT) || !set_gpio_mask_function((PinMask) bus->input_bit << bank_shift, GPIO_INPUT))
+        {
+            status = REGISTER_FAILURE;
+        }
+    }
+
+    if(status != SUCCESS)
+    {
+        free(bus);
+        return status;
+    }
+
+    bus->set_register = gpio_memory + calculate_offset(GPSET0) + bank;
+    bus->clear_register = gpio_memory + calculate_offset(GPCLR0) + bank;
+    bus->level_register = gpio_memory + calculate_offset(GPLEV0) + bank;
+    bus->active_register = serial_config->clock_idle_high ? bus->clear_register : bus->set_register;
+    bus->idle_set_bits = serial_config->clock_idle_high ? bus->clock_bit : 0x00;
+    bus->idle_clear_bits = serial_config->clock_idle_high ? 0x00 : bus->clock_bit;
+    bus->latch_mode = serial_config->latch_mode;
+    bus->lsb_first = serial_config->lsb_first;
+    bus->clock_delay = serial_config->clock_delay;
+    bus->data_pin_count = serial_config->data_pin_count;
+
+    // Precompute the set mask of every bit of every byte value for each data pin
+    for(pin = 0; pin < bus->data_pin_count; pin++)
+    {
+        for(value = 0; value < 256; value++)
+        {
+            for(bit = 0; bit < BITS_PER_BYTE; bit++)
+            {
+                shift = serial_config->lsb_first ? bit : BITS_PER_BYTE - 1 - bit;
+                bus->bit_table[pin][value][bit] = ((value >> shift) & 0x01) ? data_pin_bits[pin] : 0x00;
+            }
+        }
+    }
+
+    // Idle levels: clock idle, latch low for a pulse latch and high (deselected) for a chip select
+    *bus->set_register = bus->idle_set_bits;
+    *bus->clear_register = bus->idle_clear_bits;
+
+    if(bus->latch_bit != 0x00)
+    {
+        if(bus->latch_mode == LATCH_SELECT)
+        {
+            *bus->set_register = bus->latch_bit;
+        }
+        else
+        {
+            *bus->clear_register = bus->latch_bit;
+        }
+    }
+
+    *serial_bus = bus;
+
+    return SUCCESS;
+}
+
+void write_serial_bus(SerialBus* serial_bus, const uint8_t* data, size_t length)
+{
+    unsigned int set_bits;
+    size_t byte;
+    int bit;
+    int pin;
+
+    begin_transfer(serial_bus);
+
+    for(byte = 0; byte < length; byte++)
+    {
+        for(bit = 0; bit < BITS_PER_BYTE; bit++)
+        {
+            set_bits = serial_bus->bit_table[0][data[0]][bit];
+
+            for(pin = 1; pin < serial_bus->data_pin_count; pin++)
+            {
+                set_bits |= serial_bus->bit_table[pin][data[pin]][bit];
+            }
+
+            // Present the data with the clock at idle, then move the clock to its active edge
+            *serial_bus->set_register = set_bits | serial_bus->idle_set_bits;
+            *serial_bus->clear_register = (serial_bus->data_bits & ~set_bits) | serial_bus->idle_clear_bits;
+            serial_delay(serial_bus->clock_delay);
+            *serial_bus->active_register = serial_bus->clock_bit;
+            serial_delay(serial_bus->clock_delay);
+        }
+
+        data += serial_bus->data_pin_count;
+    }
+
+    end_transfer(serial_bus);
+}
+
+void transfer_serial_bus(SerialBus* serial_bus, const uint8_t* output, uint8_t* input, size_t length)
+{
+    unsigned int set_bits;
+    unsigned int received;
+    size_t byte;
+    int bit;
+
+    begin_transfer(serial_bus);
+
+    for(byte = 0; byte < length; byte++)
+    {
+        received = 0x00;
+
+        for(bit = 0; bit < BITS_PER_BYTE; bit++)
+        {
+            set_bits = serial_bus->bit_table[0][output[byte]][bit];
+
+            *serial_bus->set_register = set_bits | serial_bus->idle_set_bits;
+            *serial_bus->clear_register = (serial_bus->data_bits & ~set_bits) | serial_bus->idle_clear_bits;
+            serial_delay(serial_bus->clock_delay);
+            *serial_bus->active_register = serial_bus->clock_bit;
+
+            if((*serial_bus->level_register & serial_bus->input_bit) != 0)
+            {
+                received |= serial_bus->lsb_first ? 0x01 << bit : 0x80 >> bit;
+            }
+
+            serial_delay(serial_bus->clock_delay);
+        }
+
+        input[byte] = (uint8_t) received;
+    }
+
+    end_transfer(serial_bus);
+}
+
+void close_serial_bus(SerialBus* serial_bus)
+{
+    free(serial_bus);
+}
+
+static StatusCode resolve_serial_pin(int pin_number, PinType pin_type, int* bank, unsigned int* pin_bit)
+{
+    int broadcom_number;
+
+    *pin_bit = 0x00;
+
+    if(pin_number == SERIAL_NO_PIN)
+    {
+        return SUCCESS;
+    }
+
+    // Attempt to get the Broadcom pin number
+    if(!pin_to_broadcom(pin_number, pin_type, &broadcom_number))
+    {
+        return INVALID_PIN;
+    }
+
+    // Every pin must share one bank, so each step is a single store
+    if(*bank >= 0 && *bank != broadcom_number / REGISTER_SIZE)
+    {
+        return INVALID_PIN;
+    }
+
+    *bank = broadcom_number / REGISTER_SIZE;
+    *pin_bit = 0x01 << (broadcom_number % REGISTER_SIZE);
+
+    return SUCCESS;
+}
+
+static void begin_transfer(SerialBus* serial_bus)
+{
+    if(serial_bus->latch_bit != 0x00 && serial_bus->latch_mode == LATCH_SELECT)
+    {
+        *serial_bus->clear_register = serial_bus->latch_bit;
+        serial_delay(serial_bus->clock_delay);
+    }
+}
+
+static void end_transfer(SerialBus* serial_bus)
+{
+    *serial_bus->set_register = serial_bus->idle_set_bits;
+    *serial_bus->clear_register = serial_bus->idle_clear_bits;
+    serial_delay(serial_bus->clock_delay);
+
+    if(serial_bus->latch_bit != 0x00)
+    {
+        if(serial_bus->latch_mode == LATCH_SELECT)
+        {
+            *serial_bus->set_register = serial_bus->latch_bit;
+        }
+        else
+        {
+            *serial_bus->set_register = serial_bus->latch_bit;
+            serial_delay(serial_bus->clock_delay);
+            *serial_bus->clear_register = serial_bus->latch_bit;
+        }
+    }
+}
@@ -0,0 +1,128 @@
+/*
+ * File:        serial.h
+ * Description: Definition of the bit-banged serial (SPI and shift register) functions and data types.
+ * Programmer:  tnewman
+ * Date:        Oct 16, 2026
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 Thomas Newman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef SERIAL_H
+#define SERIAL_H
+
+#include "gpio.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Configuration
+ */
+#define SERIAL_MAX_DATA_PINS 8
+#define SERIAL_NO_PIN -1
+
+/*
+ * Name: LatchMode
+ * Description: LatchMode specifies how the latch pin of a serial bus is driven.
+ */
+typedef enum {
+    LATCH_PULSE, // The latch is pulsed high after each transfer (74HC595 RCLK).
+    LATCH_SELECT // The latch is held low during each transfer (SPI chip select).
+} LatchMode;
+
+/*
+ * Name: SerialConfig
+ * Description: The pins and timing of a bit-banged serial bus. Every pin must be in the same register bank (every 
+ *              pin on the P1 connector is).
+ */
+typedef struct {
+    PinType pin_type; // The numbering convention used to identify the pins.
+    int clock_pin; // The clock pin (SCLK or SRCLK).
+    int latch_pin; // The latch or chip select pin, or SERIAL_NO_PIN.
+    int input_pin; // The input pin (MISO), or SERIAL_NO_PIN.
+    int data_pins[SERIAL_MAX_DATA_PINS]; // The data pins (MOSI or SER), clocked in parallel.
+    int data_pin_count; // Number of data pins.
+    LatchMode latch_mode; // How the latch pin is driven.
+    bool clock_idle_high; // true if the clock idles high (SPI mode 2), otherwise it idles low (SPI mode 0).
+    bool lsb_first; // true to send the least significant bit of each byte first.
+    unsigned int clock_delay; // Delay loop iterations after each clock edge (0 runs as fast as possible).
+} SerialConfig;
+
+/*
+ * Name: SerialBus
+ * Description: An open serial bus with its precomputed mask tables. For every data pin, the table holds the set mask 
+ *              of each bit of each byte value, so clocking out a bit is a table lookup and three stores.
+ */
+typedef struct SerialBus SerialBus;
+
+/*
+ * Name: open_serial_bus
+ * Description: Validates the pins of a serial bus, sets their modes and idle levels, and precomputes the mask tables.
+ * Note: Must be called after initialize_gpio.
+ * Parameters:
+ *       serial_config[in] - The pins and timing of the bus.
+ *       serial_bus[out] - The open bus.
+ * Returns: Result of the operation.
+ */
+StatusCode open_serial_bus(const SerialConfig* serial_config, SerialBus** serial_bus);
+
+/*
+ * Name: write_serial_bus
+ * Description: Clocks out a buffer on every data pin in parallel, then drives the latch. With several data pins, 
+ *              the buffer is interleaved: byte i of data pin n is data[i * data_pin_count + n].
+ * Note: No checks are made.
+ * Parameters:
+ *       serial_bus[in] - The open bus.
+ *       data[in] - The bytes to send.
+ *       length[in] - Number of bytes to send on each data pin.
+ * Returns: None
+ */
+void write_serial_bus(SerialBus* serial_bus, const uint8_t* data, size_t length);
+
+/*
+ * Name: transfer_serial_bus
+ * Description: Clocks out a buffer on the first data pin while reading the input pin (full-duplex SPI). The input is 
+ *              sampled on the leading clock edge, along with the output.
+ * Note: No checks are made. The bus must have an input pin.
+ * Parameters:
+ *       serial_bus[in] - The open bus.
+ *       output[in] - The bytes to send.
+ *       input[out] - The bytes received.
+ *       length[in] - Number of bytes to transfer.
+ * Returns: None
+ */
+void transfer_serial_bus(SerialBus* serial_bus, const uint8_t* output, uint8_t* input, size_t length);
+
+/*
+ * Name: close_serial_bus
+ * Description: Frees a serial bus. The pins keep their modes and levels.
+ * Parameters:
+ *       serial_bus[in] - The open bus.
+ * Returns: None
+ */
+void close_serial_bus(SerialBus* serial_bus);
+
+#endif /* SERIAL_H_ */
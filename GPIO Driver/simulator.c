@@ -0,0 +1,305 @@
+/*
+ * File:        simulator.c
+ * Description: Simulated GPIO register implementation.
+ * Programmer:  tnewman
+ * Date:        Oct 16, 2026
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 Thomas Newman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "simulator.h"
+#include "internal.h"
+
+#include <stdbool.h>
+
+/*
+ * Implementation Functions
+ *
+ * These functions are for internal use only.
+ */
+
+/*
+ * Name: check_simulation
+ * Description: Checks that the library has been initialized with the simulated backend.
+ * Parameters: None
+ * Returns: true if the simulated registers are mapped, otherwise false.
+ */
+static bool check_simulation();
+
+/*
+ * Name: get_output_pins
+ * Description: Finds every pin whose function select bits make it an output.
+ * Parameters:
+ *       registers[in] - The simulated registers.
+ * Returns: The output pins (Broadcom numbering).
+ */
+static PinMask get_output_pins(volatile Register_Type* registers);
+
+/*
+ * Name: translate_bus_address
+ * Description: Finds the simulated memory behind a bus address used by a DMA control block: the memory of the 
+ *              waveform, or the simulated GPIO or PWM registers.
+ * Parameters:
+ *       dma_waveform[in] - The waveform being played.
+ *       bus_address[in] - The bus address.
+ *       length[in] - Number of bytes accessed from the address.
+ * Returns: The simulated memory, or 0x00 if the range is not backed by anything.
+ */
+static volatile uint32_t* translate_bus_address(const DmaWaveform* dma_waveform, uint32_t bus_address, 
+        uint32_t length);
+
+StatusCode update_simulated_gpio()
+{
+    SimulatedGpio* simulation;
+    PinMask set_bits;
+    PinMask clear_bits;
+    PinMask output_pins;
+    PinMask previous_levels;
+    PinMask levels;
+    PinMask events;
+
+    if(!check_simulation())
+    {
+        return NO_INIT;
+    }
+
+    simulation = (SimulatedGpio*) gpio_memory;
+
+    // The level registers' lock stands for the whole simulation
+    lock_register(GPLEV0);
+
+    // Collect the pending stores to the set and clear registers, then consume them like the hardware does
+    set_bits = read_register_pair(GPSET0);
+    clear_bits = read_register_pair(GPCLR0);
+
+    gpio_memory[calculate_offset(GPSET0)] = 0x00;
+    gpio_memory[calculate_offset(GPSET1)] = 0x00;
+    gpio_memory[calculate_offset(GPCLR0)] = 0x00;
+    gpio_memory[calculate_offset(GPCLR1)] = 0x00;
+
+    simulation->output_latch = (simulation->output_latch | set_bits) & ~clear_bits;
+
+    // Outputs read back the latch, every other pin reads the simulated inputs
+    output_pins = get_output_pins(gpio_memory);
+    previous_levels = read_register_pair(GPLEV0);
+    levels = (simulation->output_latch & output_pins) | (simulation->input_levels & ~output_pins);
+
+    gpio_memory[calculate_offset(GPLEV0)] = (unsigned int) levels;
+    gpio_memory[calculate_offset(GPLEV1)] = (unsigned int) (levels >> REGISTER_SIZE);
+
+    // Latch the events enabled by the detect registers (asynchronous edges behave like synchronous ones here)
+    events = (read_register_pair(GPREN0) | read_register_pair(GPAREN0)) & ~previous_levels & levels;
+    events |= (read_register_pair(GPFEN0) | read_register_pair(GPAFEN0)) & previous_levels & ~levels;
+    events |= read_register_pair(GPHEN0) & levels;
+    events |= read_register_pair(GPLEN0) & ~levels;
+
+    lock_register(GPEDS0);
+    gpio_memory[calculate_offset(GPEDS0)] |= (unsigned int) events;
+    gpio_memory[calculate_offset(GPEDS1)] |= (unsigned int) (events >> REGISTER_SIZE);
+    unlock_register(GPEDS0);
+
+    unlock_register(GPLEV0);
+
+    return SUCCESS;
+}
+
+StatusCode set_simulated_inputs(PinMask pin_values)
+{
+    if(!check_simulation())
+    {
+        return NO_INIT;
+    }
+
+    lock_register(GPLEV0);
+    ((SimulatedGpio*) gpio_memory)->input_levels = pin_values;
+    unlock_register(GPLEV0);
+
+    return update_simulated_gpio();
+}
+
+StatusCode get_simulated_outputs(PinMask* pin_values)
+{
+    StatusCode status;
+
+    status = update_simulated_gpio();
+
+    if(status != SUCCESS)
+    {
+        return status;
+    }
+
+    *pin_values = ((SimulatedGpio*) gpio_memory)->output_latch;
+
+    return SUCCESS;
+}
+
+StatusCode step_simulated_dma(const DmaWaveform* dma_waveform, PinMask* pin_values, unsigned int* ticks)
+{
+    volatile Register_Type* status_register;
+    volatile Register_Type* control_block_register;
+    volatile DmaControlBlock* control_block;
+    volatile uint32_t* source;
+    volatile uint32_t* destination;
+    uint32_t transfer_information;
+    uint32_t word;
+    bool paced;
+    int control_blocks;
+
+    if(!check_simulation())
+    {
+        return NO_INIT;
+    }
+
+    if(dma_waveform->channel < 0 || peripheral_memory[DMA_REGION] == 0x00)
+    {
+        return UNSUPPORTED;
+    }
+
+    status_register = peripheral_memory[DMA_REGION] + 
+            calculate_region_offset(DMA_CS + dma_waveform->channel * DMA_CHANNEL_STRIDE, DMA_MEMORY_START);
+    control_block_register = peripheral_memory[DMA_REGION] + 
+            calculate_region_offset(DMA_CONBLK_AD + dma_waveform->channel * DMA_CHANNEL_STRIDE, DMA_MEMORY_START);
+
+    if((*status_register & DMA_CS_ACTIVE) == 0)
+    {
+        return UNSUPPORTED;
+    }
+
+    *ticks = 0;
+    paced = false;
+
+    // A chain without any pacing could loop forever, so a call runs at most one pass over the chain
+    for(control_blocks = 0; !paced && control_blocks < dma_waveform->control_block_count; control_blocks++)
+    {
+        control_block = (volatile DmaControlBlock*) translate_bus_address(dma_waveform, *control_block_register, 
+                sizeof(DmaControlBlock));
+
+        if(control_block == 0x00)
+        {
+            *status_register = DMA_CS_ERROR;
+            return REGISTER_FAILURE;
+        }
+
+        transfer_information = control_block->transfer_information;
+        source = translate_bus_address(dma_waveform, control_block->source_address, 
+                (transfer_information & DMA_TI_SRC_INC) != 0 ? control_block->transfer_length : sizeof(uint32_t));
+        destination = translate_bus_address(dma_waveform, control_block->destination_address, 
+                (transfer_information & DMA_TI_DEST_INC) != 0 ? control_block->transfer_length : sizeof(uint32_t));
+
+        if(source == 0x00 || destination == 0x00)
+        {
+            *status_register = DMA_CS_ERROR;
+            return REGISTER_FAILURE;
+        }
+
+        // Copy the words one at a time, the way the engine does without wide bursts
+        for(word = 0; word < control_block->transfer_length / sizeof(uint32_t); word++)
+        {
+            destination[(transfer_information & DMA_TI_DEST_INC) != 0 ? word : 0] = 
+                    source[(transfer_information & DMA_TI_SRC_INC) != 0 ? word : 0];
+        }
+
+        // Writes paced by the PWM controller take one tick each
+        if((transfer_information & DMA_TI_DEST_DREQ) != 0 && 
+                (transfer_information >> DMA_TI_PERMAP_SHIFT & DMA_TI_PERMAP_BITS) == DMA_DREQ_PWM)
+        {
+            *ticks += control_block->transfer_length / sizeof(uint32_t);
+            paced = true;
+        }
+
+        // The set and clear registers only hold the last store, so each output is applied before the next one
+        if(destination >= gpio_memory && destination < gpio_memory + GPIO_MEMORY_SIZE / sizeof(Register_Type))
+        {
+            update_simulated_gpio();
+        }
+
+        *control_block_register = control_block->next_control_block;
+
+        if(control_block->next_control_block == 0x00)
+        {
+            *status_register = DMA_CS_END;
+            break;
+        }
+    }
+
+    return get_simulated_outputs(pin_values);
+}
+
+static bool check_simulation()
+{
+    if(gpio_memory == 0x00 || backend != SIMULATED_BACKEND)
+    {
+        return false;
+    }
+
+    return true;
+}
+
+static PinMask get_output_pins(volatile Register_Type* registers)
+{
+    int pins_per_register = REGISTER_SIZE / GPFSEL_BITS_PER_PIN;
+    int broadcom_number;
+    unsigned int function_code;
+    PinMask output_pins = 0x00;
+
+    for(broadcom_number = 0; broadcom_number <= GPIO_PIN_COUNT; broadcom_number++)
+    {
+        function_code = registers[calculate_offset(GPFSEL0) + broadcom_number / pins_per_register];
+        function_code >>= (broadcom_number % pins_per_register) * GPFSEL_BITS_PER_PIN;
+
+        if((function_code & GPFSEL_BITS) == GPIO_OUTPUT)
+        {
+            output_pins |= (PinMask) 1 << broadcom_number;
+        }
+    }
+
+    return output_pins;
+}
+
+static volatile uint32_t* translate_bus_address(const DmaWaveform* dma_waveform, uint32_t bus_address, 
+        uint32_t length)
+{
+    if(bus_address >= dma_waveform->bus_address && 
+            bus_address - dma_waveform->bus_address + length <= dma_waveform->memory_size)
+    {
+        return (volatile uint32_t*) ((volatile char*) dma_waveform->control_blocks + 
+                (bus_address - dma_waveform->bus_address));
+    }
+
+    if(bus_address >= calculate_bus_address(GPIO_MEMORY_START) && 
+            bus_address - calculate_bus_address(GPIO_MEMORY_START) + length <= GPIO_MEMORY_SIZE)
+    {
+        return gpio_memory + (bus_address - calculate_bus_address(GPIO_MEMORY_START)) / sizeof(Register_Type);
+    }
+
+    if(peripheral_memory[PWM_REGION] != 0x00 && bus_address >= calculate_bus_address(PWM_MEMORY_START) && 
+            bus_address - calculate_bus_address(PWM_MEMORY_START) + length <= PWM_MEMORY_SIZE)
+    {
+        return peripheral_memory[PWM_REGION] + 
+                (bus_address - calculate_bus_address(PWM_MEMORY_START)) / sizeof(Register_Type);
+    }
+
+    return 0x00;
+}
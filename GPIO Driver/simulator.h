@@ -0,0 +1,105 @@
+/*
+ * File:        simulator.h
+ * Description: Definition of the functions used to drive the simulated GPIO registers.
+ * Programmer:  tnewman
+ * Date:        Oct 16, 2026
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 Thomas Newman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include "gpio.h"
+#include "dma.h"
+
+/*
+ * Simulation Model
+ *
+ * SIMULATED_BACKEND keeps the GPIO registers in ordinary memory, so nothing reacts to a store when it happens.
+ * update_simulated_gpio plays the part of the hardware:
+ * - GPSET0/1 and GPCLR0/1 hold the last value stored to them. Their bits are applied to the output latch and the
+ *   registers are cleared, so only the last store to each register since the previous update is seen.
+ * - GPLEV0/1 are rebuilt from the output latch for output pins and from the simulated inputs for every other pin.
+ * - GPEDS0/1 latch the events enabled in the detect enable registers by comparing the levels before and after the
+ *   update. Asynchronous edges are detected like synchronous ones.
+ * - GPFSEL0-5 and the detect enable registers are plain memory, which models them exactly.
+ * - The PWM and clock manager registers follow the GPIO registers in the register file and are plain memory, so the
+ *   values programmed by pwm.h can be read back with get_gpio_peripheral_registers. Clocks never report BUSY.
+ * - The DMA channel registers are plain memory as well. step_simulated_dma plays the part of a DMA engine running
+ *   the chain of a DMA waveform.
+ * - The system timer is not simulated, because plain memory does not count. systimer.h falls back to CLOCK_MONOTONIC.
+ */
+
+/*
+ * Name: update_simulated_gpio
+ * Description: Applies pending GPSET and GPCLR stores to the simulated output latch and rebuilds the simulated level
+ *              registers.
+ * Note: Must be called after initialize_gpio_backend(SIMULATED_BACKEND).
+ * Parameters: None
+ * Returns: Result of the operation.
+ */
+StatusCode update_simulated_gpio();
+
+/*
+ * Name: set_simulated_inputs
+ * Description: Sets the levels driven onto the simulated pins from outside, then updates the simulation. Only pins
+ *              that are not outputs show these levels.
+ * Note: Must be called after initialize_gpio_backend(SIMULATED_BACKEND).
+ * Parameters:
+ *       pin_values[in] - The levels of the simulated inputs (Broadcom numbering).
+ * Returns: Result of the operation.
+ */
+StatusCode set_simulated_inputs(PinMask pin_values);
+
+/*
+ * Name: get_simulated_outputs
+ * Description: Updates the simulation, then gets the simulated output latch.
+ * Note: Must be called after initialize_gpio_backend(SIMULATED_BACKEND).
+ * Parameters:
+ *       pin_values[out] - The levels driven by the output latch (Broadcom numbering).
+ * Returns: Result of the operation.
+ */
+StatusCode get_simulated_outputs(PinMask* pin_values);
+
+/*
+ * Name: step_simulated_dma
+ * Description: Runs the control blocks of a started DMA waveform on its simulated channel, up to and including the 
+ *              next control block that waits for the PWM pacing, and updates the simulation after every store to 
+ *              the GPIO registers. A control block that reads or writes anything other than the memory of the 
+ *              waveform, the GPIO registers, or the PWM registers stops the channel with an error, like a bus error 
+ *              would.
+ * Note: Must be called after start_gpio_dma_waveform with SIMULATED_BACKEND. Loop while check_gpio_dma_waveform 
+ *       returns true to play the whole chain.
+ * Parameters:
+ *       dma_waveform[in] - The started waveform.
+ *       pin_values[out] - The simulated output latch after the control blocks ran (Broadcom numbering).
+ *       ticks[out] - Number of pacing ticks the control blocks waited for.
+ * Returns: Result of the operation (UNSUPPORTED if the channel is not running, REGISTER_FAILURE if the chain is 
+ *          broken).
+ */
+StatusCode step_simulated_dma(const DmaWaveform* dma_waveform, PinMask* pin_values, unsigned int* ticks);
+
+#endif /* SIMULATOR_H_ */
@@ -0,0 +1,298 @@
+/*
+ * File:        softpwm.c
+ * Description: Multi-channel software PWM engine implementation.
+ * Programmer:  tnewman
+ * Date:        Oct 16, 2026
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 Thomas Newman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#define _GNU_SOURCE
+
+#include "softpwm.h"
+#include "internal.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*
+ * Configuration
+ */
+#define NANOSECONDS_PER_SECOND 1000000000L
+
+/*
+ * Name: SoftPwmEngine
+ * Description: Each channel's period and duty are packed into one 64-bit word (period in the high half), so a
+ *              channel is always updated as a whole with a single atomic store. Channels are only ever added to the
+ *              shared channel mask, which avoids races between adding and removing a channel.
+ */
+struct SoftPwmEngine {
+    pthread_t timing_thread;
+    atomic_bool running;
+    unsigned int tick;
+    atomic_uint_fast64_t channel_mask; // Broadcom pins that have a channel
+    atomic_uint_fast64_t settings[GPIO_PIN_COUNT + 1]; // Period and duty of each Broadcom pin
+
+    // Owned by the timing thread
+    unsigned int counters[GPIO_PIN_COUNT + 1];
+    unsigned int periods[GPIO_PIN_COUNT + 1];
+    unsigned int duties[GPIO_PIN_COUNT + 1];
+};
+
+/*
+ * Implementation Functions
+ *
+ * These functions are for internal use only.
+ */
+
+/*
+ * Name: run_soft_pwm
+ * Description: Body of the timing thread.
+ * Parameters:
+ *       argument[in] - The software PWM engine.
+ * Returns: Always 0x00.
+ */
+static void* run_soft_pwm(void* argument);
+
+StatusCode start_soft_pwm(unsigned int tick, int cpu, SoftPwmEngine** soft_pwm_engine)
+{
+    SoftPwmEngine* engine;
+    cpu_set_t cpu_set;
+    pthread_attr_t thread_attributes;
+    int broadcom_number;
+    int result;
+
+    // Check initialization
+    if(!check_init())
+    {
+        return NO_INIT;
+    }
+
+    if(cpu >= CPU_SETSIZE)
+    {
+        return UNSUPPORTED;
+    }
+
+    engine = calloc(1, sizeof(SoftPwmEngine));
+
+    if(engine == 0x00)
+    {
+        return REGISTER_FAILURE;
+    }
+
+    engine->tick = tick;
+    atomic_init(&engine->running, true);
+    atomic_init(&engine->channel_mask, 0x00);
+
+    for(broadcom_number = 0; broadcom_number <= GPIO_PIN_COUNT; broadcom_number++)
+    {
+        atomic_init(&engine->settings[broadcom_number], 0x00);
+    }
+
+    // The timing thread is placed on its CPU before it runs, so no tick is timed on the wrong core
+    if(pthread_attr_init(&thread_attributes) != 0)
+    {
+        free(engine);
+        return REGISTER_FAILURE;
+    }
+
+    result = 0;
+
+    if(cpu >= 0)
+    {
+        CPU_ZERO(&cpu_set);
+        CPU_SET(cpu, &cpu_set);
+        result = pthread_attr_setaffinity_np(&thread_attributes, sizeof(cpu_set), &cpu_set);
+    }
+
+    if(result == 0)
+    {
+        result = pthread_create(&engine->timing_thread, &thread_attributes, run_soft_pwm, engine);
+    }
+
+    pthread_attr_destroy(&thread_attributes);
+
+    if(result != 0)
+    {
+        free(engine);
+        return REGISTER_FAILURE;
+    }
+
+    *soft_pwm_engine = engine;
+
+    return SUCCESS;
+}
+
+StatusCode set_soft_pwm(SoftPwmEngine* soft_pwm_engine, int pin_number, PinType pin_type, unsigned int period,
+        unsigned int duty)
+{
+    int broadcom_number;
+
+    // Check initialization
+    if(!check_init())
+    {
+        return NO_INIT;
+    }
+
+    // Attempt to get the Broadcom pin number
+    if(!pin_to_broadcom(pin_number, pin_type, &broadcom_number))
+    {
+        return INVALID_PIN;
+    }
+
+    // Set the pin function to output mode
+    if(!set_gpio_pin_function(broadcom_number, GPIO_OUTPUT))
+    {
+        return REGISTER_FAILURE;
+    }
+
+    // Publish the settings before the channel, so a new channel never starts with stale settings
+    atomic_store_explicit(&soft_pwm_engine->settings[broadcom_number], ((uint64_t) period << 32) | duty,
+            memory_order_relaxed);
+    atomic_fetch_or_explicit(&soft_pwm_engine->channel_mask, (PinMask) 1 << broadcom_number, memory_order_release);
+
+    return SUCCESS;
+}
+
+void stop_soft_pwm(SoftPwmEngine* soft_pwm_engine)
+{
+    atomic_store_explicit(&soft_pwm_engine->running, false, memory_order_relaxed);
+    pthread_join(soft_pwm_engine->timing_thread, 0x00);
+
+    free(soft_pwm_engine);
+}
+
+static void* run_soft_pwm(void* argument)
+{
+    SoftPwmEngine* engine = argument;
+    volatile Register_Type* set_register = gpio_memory + calculate_offset(GPSET0);
+    volatile Register_Type* clear_register = gpio_memory + calculate_offset(GPCLR0);
+    struct timespec deadline;
+    PinMask channels;
+    PinMask set_bits;
+    PinMask clear_bits;
+    PinMask pin_bit;
+    uint64_t settings;
+    unsigned int previous_period;
+    int broadcom_number;
+
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+
+    while(atomic_load_explicit(&engine->running, memory_order_relaxed))
+    {
+        channels = atomic_load_explicit(&engine->channel_mask, memory_order_acquire);
+        set_bits = 0x00;
+        clear_bits = 0x00;
+
+        // Collect the edges of every channel for this tick
+        while(channels != 0x00)
+        {
+            broadcom_number = __builtin_ctzll(channels);
+            pin_bit = (PinMask) 1 << broadcom_number;
+            channels &= channels - 1;
+
+            // New settings only take effect at the start of a period
+            if(engine->counters[broadcom_number] == 0)
+            {
+                previous_period = engine->periods[broadcom_number];
+                settings = atomic_load_explicit(&engine->settings[broadcom_number], memory_order_relaxed);
+                engine->periods[broadcom_number] = (unsigned int) (settings >> 32);
+                engine->duties[broadcom_number] = (unsigned int) settings;
+
+                // A stopped channel is cleared once, then checked again on every tick
+                if(engine->periods[broadcom_number] == 0)
+                {
+                    if(previous_period != 0)
+                    {
+                        clear_bits |= pin_bit;
+                    }
+
+                    continue;
+                }
+
+                if(engine->duties[broadcom_number] == 0)
+                {
+                    clear_bits |= pin_bit;
+                }
+                else
+                {
+                    set_bits |= pin_bit;
+                }
+            }
+
+            if(engine->counters[broadcom_number] == engine->duties[broadcom_number])
+            {
+                clear_bits |= pin_bit;
+            }
+
+            if(++engine->counters[broadcom_number] >= engine->periods[broadcom_number])
+            {
+                engine->counters[broadcom_number] = 0;
+            }
+        }
+
+        // A channel that is cleared and set on the same tick (duty 0) must end up cleared
+        set_bits &= ~clear_bits;
+
+        // One store per register and bank for the whole tick
+        if((set_bits & 0xFFFFFFFF) != 0)
+        {
+            set_register[0] = (unsigned int) set_bits;
+        }
+
+        if((set_bits >> REGISTER_SIZE) != 0)
+        {
+            set_register[1] = (unsigned int) (set_bits >> REGISTER_SIZE);
+        }
+
+        if((clear_bits & 0xFFFFFFFF) != 0)
+        {
+            clear_register[0] = (unsigned int) clear_bits;
+        }
+
+        if((clear_bits >> REGISTER_SIZE) != 0)
+        {
+            clear_register[1] = (unsigned int) (clear_bits >> REGISTER_SIZE);
+        }
+
+        // Sleep until the next tick on an absolute deadline, so the tick length does not drift
+        deadline.tv_nsec += engine->tick;
+
+        while(deadline.tv_nsec >= NANOSECONDS_PER_SECOND)
+        {
+            deadline.tv_nsec -= NANOSECONDS_PER_SECOND;
+            deadline.tv_sec++;
+        }
+
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, 0x00);
+    }
+
+    return 0x00;
+}
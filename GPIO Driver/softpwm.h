@@ -0,0 +1,83 @@
+/*
+ * File:        softpwm.h
+ * Description: Definition of the multi-channel software PWM engine.
+ * Programmer:  tnewman
+ * Date:        Oct 16, 2026
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 Thomas Newman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef SOFTPWM_H
+#define SOFTPWM_H
+
+#include "gpio.h"
+
+/*
+ * Name: SoftPwmEngine
+ * Description: A running software PWM engine. One timing thread drives every channel. On each tick it combines the
+ *              edges of all channels into one set mask and one clear mask and writes them with at most one GPSET and
+ *              one GPCLR store per bank. Periods and duty cycles are measured in ticks.
+ */
+typedef struct SoftPwmEngine SoftPwmEngine;
+
+/*
+ * Name: start_soft_pwm
+ * Description: Starts the timing thread of a software PWM engine without any channels.
+ * Note: Must be called after initialize_gpio.
+ * Parameters:
+ *       tick[in] - Length of a tick in nanoseconds.
+ *       cpu[in] - The CPU to run the timing thread on, or a negative number to let the scheduler choose.
+ *       soft_pwm_engine[out] - The running engine.
+ * Returns: Result of the operation (UNSUPPORTED if the CPU is beyond CPU_SETSIZE, REGISTER_FAILURE if the thread 
+ *          cannot be started on it).
+ */
+StatusCode start_soft_pwm(unsigned int tick, int cpu, SoftPwmEngine** soft_pwm_engine);
+
+/*
+ * Name: set_soft_pwm
+ * Description: Sets the period and duty cycle of the channel on a GPIO pin, adding the channel if needed. The pin is
+ *              switched to output mode. The change is stored without locks and the timing thread picks it up at the
+ *              start of the channel's next period, so a cycle is never cut short.
+ * Parameters:
+ *       soft_pwm_engine[in] - The running engine.
+ *       pin_number[in] - The GPIO pin number of the channel.
+ *       pin_type[in] - The numbering convention used to identify the GPIO pin.
+ *       period[in] - Period in ticks, or 0 to stop the channel and leave the pin cleared.
+ *       duty[in] - Ticks per period that the pin is high. Values at or above the period keep the pin high.
+ * Returns: Result of the operation.
+ */
+StatusCode set_soft_pwm(SoftPwmEngine* soft_pwm_engine, int pin_number, PinType pin_type, unsigned int period,
+        unsigned int duty);
+
+/*
+ * Name: stop_soft_pwm
+ * Description: Stops the timing thread and frees the engine. The pins keep the level they had last.
+ * Parameters:
+ *       soft_pwm_engine[in] - The running engine.
+ * Returns: None
+ */
+void stop_soft_pwm(SoftPwmEngine* soft_pwm_engine);
+
+#endif /* SOFTPWM_H_ */
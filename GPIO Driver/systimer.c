@@ -0,0 +1,171 @@
+/*
+ * File:        systimer.c
+ * Description: Timestamps and busy-wait delays from the free running counter of the system timer.
+ * Programmer:  tnewman
+ * Date:        Oct 16, 2026
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 Thomas Newman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+#include "systimer.h"
+#include "internal.h"
+
+#include <time.h>
+
+/*
+ * Configuration
+ */
+#define CALIBRATION_CHUNK 1000
+#define CALIBRATION_ROUND 1000 // Microseconds of one calibration round
+
+/*
+ * Global Variables
+ */
+static double delay_loops_per_microsecond = 0.0; // Calibration of the delay loop against the timer
+
+/*
+ * Implementation Functions
+ *
+ * These functions are for internal use only.
+ */
+
+/*
+ * Name: get_monotonic_timestamp
+ * Description: Reads CLOCK_MONOTONIC in microseconds (the fallback when the system timer is not mapped).
+ * Parameters: None
+ * Returns: The timestamp in microseconds.
+ */
+static uint64_t get_monotonic_timestamp();
+
+/*
+ * Name: delay_loop
+ * Description: Spins for a number of iterations. The empty assembly statement keeps the compiler from removing the 
+ *              loop, and the function is never inlined so calibration and delays run the same code.
+ * Parameters:
+ *       iterations[in] - Number of iterations to spin for.
+ * Returns: None
+ */
+static void __attribute__((noinline)) delay_loop(unsigned long iterations);
+
+uint64_t get_gpio_timestamp()
+{
+    volatile Register_Type* timer;
+    uint32_t high;
+    uint32_t low;
+
+    timer = peripheral_memory[TIMER_REGION];
+
+    if(timer == 0x00)
+    {
+        return get_monotonic_timestamp();
+    }
+
+    // CLO can wrap between the loads, so read CHI on both sides of it until they agree
+    do
+    {
+        high = timer[calculate_region_offset(TIMER_CHI, TIMER_MEMORY_START)];
+        low = timer[calculate_region_offset(TIMER_CLO, TIMER_MEMORY_START)];
+    }
+    while(high != timer[calculate_region_offset(TIMER_CHI, TIMER_MEMORY_START)]);
+
+    return (uint64_t) high << REGISTER_SIZE | low;
+}
+
+void spin_gpio_until(uint64_t timestamp)
+{
+    while(get_gpio_timestamp() < timestamp)
+    {
+    }
+}
+
+void spin_gpio_delay(unsigned int microseconds)
+{
+    // The first tick may come right after the start is read, so one more is waited for
+    spin_gpio_until(get_gpio_timestamp() + microseconds + 1);
+}
+
+void calibrate_gpio_delay()
+{
+    uint64_t start;
+    uint64_t elapsed;
+    unsigned long iterations;
+    double rate;
+    int round;
+
+    delay_loops_per_microsecond = 0.0;
+
+    // A round that was preempted ran fewer iterations, so the fastest round is the one without interruptions
+    for(round = 0; round < TIMER_CALIBRATION_TIME / CALIBRATION_ROUND; round++)
+    {
+        // Start on a tick, so the measurement is not a partial microsecond short
+        start = get_gpio_timestamp();
+
+        while(get_gpio_timestamp() == start)
+        {
+        }
+
+        start = get_gpio_timestamp();
+        iterations = 0;
+
+        do
+        {
+            delay_loop(CALIBRATION_CHUNK);
+            iterations += CALIBRATION_CHUNK;
+            elapsed = get_gpio_timestamp() - start;
+        }
+        while(elapsed < CALIBRATION_ROUND);
+
+        rate = (double) iterations / elapsed;
+        delay_loops_per_microsecond = rate > delay_loops_per_microsecond ? rate : delay_loops_per_microsecond;
+    }
+}
+
+void spin_gpio_nanoseconds(unsigned int nanoseconds)
+{
+    if(delay_loops_per_microsecond == 0.0)
+    {
+        calibrate_gpio_delay();
+    }
+
+    delay_loop((unsigned long) (nanoseconds * delay_loops_per_microsecond / 1000.0));
+}
+
+static uint64_t get_monotonic_timestamp()
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return (uint64_t) time.tv_sec * TIMER_FREQUENCY + time.tv_nsec / (1000000000 / TIMER_FREQUENCY);
+}
+
+static void __attribute__((noinline)) delay_loop(unsigned long iterations)
+{
+    while(iterations-- > 0)
+    {
+        __asm__ volatile("");
+    }
+}
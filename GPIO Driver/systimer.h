@@ -0,0 +1,100 @@
+/*
+ * File:        systimer.h
+ * Description: Timestamps and busy-wait delays from the free running counter of the system timer.
+ * Programmer:  tnewman
+ * Date:        Oct 16, 2026
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 Thomas Newman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+#ifndef SYSTIMER_H
+#define SYSTIMER_H
+
+#include "gpio.h"
+
+#include <stdint.h>
+
+/*
+ * Configuration
+ */
+#define TIMER_CALIBRATION_TIME 10000 // Microseconds the delay loop of spin_gpio_nanoseconds is calibrated over
+
+/*
+ * Name: get_gpio_timestamp
+ * Description: Reads a timestamp in microseconds. With MEMORY_BACKEND it is the 64-bit system timer counter, read 
+ *              without a system call (one load of CLO and two of CHI). Without the mapped system timer 
+ *              (GPIOMEM_BACKEND, SIMULATED_BACKEND, or before initialize_gpio) it falls back to CLOCK_MONOTONIC.
+ * Note: Timestamps from the two sources cannot be compared, so only compare timestamps taken while the library stays 
+ *       initialized with the same backend.
+ * Parameters: None
+ * Returns: The timestamp in microseconds.
+ */
+uint64_t get_gpio_timestamp();
+
+/*
+ * Name: spin_gpio_until
+ * Description: Busy-waits until get_gpio_timestamp reaches a timestamp. Loops that add their period to an absolute 
+ *              timestamp keep their pace without drift, whatever the time spent between waits.
+ * Parameters:
+ *       timestamp[in] - The timestamp to wait for, in microseconds.
+ * Returns: None
+ */
+void spin_gpio_until(uint64_t timestamp);
+
+/*
+ * Name: spin_gpio_delay
+ * Description: Busy-waits for at least a number of microseconds. The counter only moves once per microsecond, so the 
+ *              delay can be up to a microsecond longer. Use spin_gpio_nanoseconds for delays finer than that.
+ * Parameters:
+ *       microseconds[in] - The delay in microseconds.
+ * Returns: None
+ */
+void spin_gpio_delay(unsigned int microseconds);
+
+/*
+ * Name: calibrate_gpio_delay
+ * Description: Times the delay loop of spin_gpio_nanoseconds against get_gpio_timestamp in rounds over 
+ *              TIMER_CALIBRATION_TIME microseconds, and keeps the fastest round. spin_gpio_nanoseconds calibrates 
+ *              automatically the first time, so this is only needed to calibrate again (for example after the CPU 
+ *              frequency has been changed).
+ * Note: Calibrate after initialize_gpio, so the loop is measured against the system timer.
+ * Parameters: None
+ * Returns: None
+ */
+void calibrate_gpio_delay();
+
+/*
+ * Name: spin_gpio_nanoseconds
+ * Description: Busy-waits for a number of nanoseconds by running the calibrated delay loop, without reading the 
+ *              timer. The delay is not cut short by the timer resolution, but it stretches if the thread is 
+ *              preempted or the CPU slows down after calibration.
+ * Parameters:
+ *       nanoseconds[in] - The delay in nanoseconds.
+ * Returns: None
+ */
+void spin_gpio_nanoseconds(unsigned int nanoseconds);
+
+#endif /* SYSTIMER_H_ */
@@ -0,0 +1,566 @@
+/*
+ * File:        trace.c
+ * Description: Capture traces recorded as run-length encoded level changes in a memory-mapped file.
+ * Programmer:  tnewman
+ * Date:        Oct 16, 2026
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 Thomas Newman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+#include "trace.h"
+
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ * Configuration
+ */
+#define TRACE_MAGIC "PIOTRACE"
+#define TRACE_MAGIC_LENGTH 8
+#define TRACE_VERSION 1
+#define KEYFRAME_SIZE (2 * sizeof(uint64_t))
+#define MAX_RECORD_SIZE 20 // Two varints of at most 10 bytes each
+#define VARINT_BITS 7
+#define VARINT_MORE 0x80
+
+/*
+ * Name: TraceHeader
+ * Description: The start of the header block of a trace file.
+ */
+typedef struct {
+    char magic[TRACE_MAGIC_LENGTH];
+    uint32_t version;
+    uint32_t block_size;
+    uint64_t pin_mask;
+} TraceHeader;
+
+struct TraceWriter {
+    int file;
+    PinMask pin_mask;
+    uint8_t* chunk; // Mapped blocks, starting at chunk_block
+    uint64_t chunk_block;
+    uint64_t block; // Block being written
+    size_t offset; // Offset of the next record in the block, or 0 before the keyframe
+    uint64_t timestamp; // Last sample written
+    PinMask levels;
+};
+
+struct TraceReader {
+    const uint8_t* memory;
+    size_t memory_size;
+    PinMask pin_mask;
+    uint64_t block_size;
+    uint64_t block_count; // Blocks in the file, counting the header
+    uint64_t block; // Block being read
+    size_t offset; // Offset of the next record in the block, or 0 before the keyframe
+    uint64_t timestamp; // Current sample
+    PinMask levels;
+    bool pending; // The current sample has not been returned yet
+};
+
+/*
+ * Implementation Functions
+ *
+ * These functions are for internal use only.
+ */
+
+/*
+ * Name: map_chunk
+ * Description: Grows the file by TRACE_GROW_BLOCKS blocks and maps them in place of the previous chunk. The blocks are 
+ *              allocated on disk first, so a full disk is reported here instead of faulting on a store.
+ * Parameters:
+ *       trace_writer[in,out] - The open writer.
+ *       first_block[in] - The first block of the new chunk.
+ * Returns: true if the chunk is mapped, otherwise false.
+ */
+static bool map_chunk(TraceWriter* trace_writer, uint64_t first_block);
+
+/*
+ * Name: pack_pins
+ * Description: Packs the traced pins of a mask, so that bit n is the nth traced pin.
+ * Parameters:
+ *       pins[in] - The pins (Broadcom numbering).
+ *       pin_mask[in] - The traced pins.
+ * Returns: The packed pins.
+ */
+static uint64_t pack_pins(PinMask pins, PinMask pin_mask);
+
+/*
+ * Name: unpack_pins
+ * Description: Reverses pack_pins.
+ * Parameters:
+ *       packed_pins[in] - The packed pins.
+ *       pin_mask[in] - The traced pins.
+ * Returns: The pins (Broadcom numbering).
+ */
+static PinMask unpack_pins(uint64_t packed_pins, PinMask pin_mask);
+
+/*
+ * Name: encode_varint
+ * Description: Encodes an unsigned LEB128 varint.
+ * Parameters:
+ *       value[in] - The value.
+ *       buffer[out] - Buffer of at least 10 bytes.
+ * Returns: Number of bytes written.
+ */
+static size_t encode_varint(uint64_t value, uint8_t* buffer);
+
+/*
+ * Name: decode_varint
+ * Description: Decodes an unsigned LEB128 varint without reading past the end of a block.
+ * Parameters:
+ *       block[in] - The block.
+ *       block_size[in] - Size of the block.
+ *       offset[in,out] - Offset of the varint, moved past it.
+ *       value[out] - The value.
+ * Returns: true if a whole varint was decoded, otherwise false.
+ */
+static bool decode_varint(const uint8_t* block, size_t block_size, size_t* offset, uint64_t* value);
+
+/*
+ * Name: next_sample
+ * Description: Moves a reader to the next sample.
+ * Parameters:
+ *       trace_reader[in,out] - The open reader.
+ * Returns: true if there is a next sample, otherwise false.
+ */
+static bool next_sample(TraceReader* trace_reader);
+
+/*
+ * Name: get_keyframe_timestamp
+ * Description: Gets the timestamp of the keyframe of a block.
+ * Parameters:
+ *       trace_reader[in] - The open reader.
+ *       block[in] - The block.
+ * Returns: The timestamp, or 0 if the block is not used.
+ */
+static uint64_t get_keyframe_timestamp(const TraceReader* trace_reader, uint64_t block);
+
+StatusCode open_gpio_trace_writer(const char* file_name, PinMask pin_mask, TraceWriter** trace_writer)
+{
+    TraceWriter* writer;
+    TraceHeader header;
+
+    writer = calloc(1, sizeof(TraceWriter));
+
+    if(writer == 0x00)
+    {
+        return REGISTER_FAILURE;
+    }
+
+    writer->file = open(file_name, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, TRACE_FILE_MODE);
+
+    if(writer->file < 0)
+    {
+        free(writer);
+        return CANNOT_MAP_MEMORY;
+    }
+
+    memset(&header, 0x00, sizeof(header));
+    memcpy(header.magic, TRACE_MAGIC, TRACE_MAGIC_LENGTH);
+    header.version = TRACE_VERSION;
+    header.block_size = TRACE_BLOCK_SIZE;
+    header.pin_mask = pin_mask;
+
+    if(pwrite(writer->file, &header, sizeof(header), 0) != sizeof(header) || 
+            ftruncate(writer->file, TRACE_BLOCK_SIZE) != 0)
+    {
+        close(writer->file);
+        free(writer);
+        return CANNOT_MAP_MEMORY;
+    }
+
+    writer->pin_mask = pin_mask;
+    writer->block = 1;
+    *trace_writer = writer;
+
+    return SUCCESS;
+}
+
+StatusCode write_gpio_trace(TraceWriter* trace_writer, const CaptureSample* samples, size_t sample_count)
+{
+    uint8_t record[MAX_RECORD_SIZE];
+    uint8_t* block;
+    uint64_t delta;
+    PinMask levels;
+    size_t record_size;
+    size_t i;
+
+    for(i = 0; i < sample_count; i++)
+    {
+        levels = samples[i].levels & trace_writer->pin_mask;
+
+        if(trace_writer->chunk != 0x00 && trace_writer->offset != 0)
+        {
+            if(levels == trace_writer->levels)
+            {
+                continue;
+            }
+
+            delta = samples[i].timestamp > trace_writer->timestamp ? samples[i].timestamp - trace_writer->timestamp : 0;
+            record_size = encode_varint(pack_pins(levels ^ trace_writer->levels, trace_writer->pin_mask), record);
+            record_size += encode_varint(delta, record + record_size);
+
+            if(trace_writer->offset + record_size <= TRACE_BLOCK_SIZE)
+            {
+                block = trace_writer->chunk + (trace_writer->block - trace_writer->chunk_block) * TRACE_BLOCK_SIZE;
+                memcpy(block + trace_writer->offset, record, record_size);
+                trace_writer->offset += record_size;
+                trace_writer->timestamp += delta;
+                trace_writer->levels = levels;
+                continue;
+            }
+
+            // The record does not fit, so the sample becomes the keyframe of the next block
+            trace_writer->block++;
+            trace_writer->offset = 0;
+        }
+
+        if(trace_writer->chunk == 0x00 || trace_writer->block >= trace_writer->chunk_block + TRACE_GROW_BLOCKS)
+        {
+            if(!map_chunk(trace_writer, trace_writer->block))
+            {
+                return CANNOT_MAP_MEMORY;
+            }
+        }
+
+        block = trace_writer->chunk + (trace_writer->block - trace_writer->chunk_block) * TRACE_BLOCK_SIZE;
+        memcpy(block, &samples[i].timestamp, sizeof(uint64_t));
+        memcpy(block + sizeof(uint64_t), &levels, sizeof(uint64_t));
+        trace_writer->offset = KEYFRAME_SIZE;
+        trace_writer->timestamp = samples[i].timestamp;
+        trace_writer->levels = levels;
+    }
+
+    return SUCCESS;
+}
+
+StatusCode close_gpio_trace_writer(TraceWriter* trace_writer)
+{
+    StatusCode status = SUCCESS;
+    uint64_t block_count;
+
+    if(trace_writer->chunk != 0x00)
+    {
+        munmap(trace_writer->chunk, TRACE_GROW_BLOCKS * TRACE_BLOCK_SIZE);
+    }
+
+    // Trim the blocks that were allocated ahead but never used
+    block_count = trace_writer->block + (trace_writer->offset != 0 ? 1 : 0);
+
+    if(ftruncate(trace_writer->file, block_count * TRACE_BLOCK_SIZE) != 0)
+    {
+        status = CANNOT_MAP_MEMORY;
+    }
+
+    close(trace_writer->file);
+    free(trace_writer);
+
+    return status;
+}
+
+StatusCode open_gpio_trace_reader(const char* file_name, PinMask* pin_mask, TraceReader** trace_reader)
+{
+    TraceReader* reader;
+    TraceHeader header;
+    struct stat file_status;
+    void* memory;
+    int file;
+
+    file = open(file_name, O_RDONLY | O_CLOEXEC);
+
+    if(file < 0)
+    {
+        return CANNOT_MAP_MEMORY;
+    }
+
+    if(fstat(file, &file_status) != 0 || (size_t) file_status.st_size < sizeof(TraceHeader))
+    {
+        close(file);
+        return UNSUPPORTED;
+    }
+
+    memory = mmap(0x00, file_status.st_size, PROT_READ, MAP_SHARED, file, 0);
+    close(file);
+
+    if(memory == MAP_FAILED)
+    {
+        return CANNOT_MAP_MEMORY;
+    }
+
+    memcpy(&header, memory, sizeof(header));
+
+    // The header takes a whole block, so a shorter file has been cut off
+    if(memcmp(header.magic, TRACE_MAGIC, TRACE_MAGIC_LENGTH) != 0 || header.version != TRACE_VERSION || 
+            header.block_size < KEYFRAME_SIZE + MAX_RECORD_SIZE || (uint64_t) file_status.st_size < header.block_size)
+    {
+        munmap(memory, file_status.st_size);
+        return UNSUPPORTED;
+    }
+
+    reader = calloc(1, sizeof(TraceReader));
+
+    if(reader == 0x00)
+    {
+        munmap(memory, file_status.st_size);
+        return REGISTER_FAILURE;
+    }
+
+    // Sequential decoding is the common case, and seeking only touches the keyframes it compares
+    madvise(memory, file_status.st_size, MADV_SEQUENTIAL);
+
+    reader->memory = memory;
+    reader->memory_size = file_status.st_size;
+    reader->pin_mask = header.pin_mask;
+    reader->block_size = header.block_size;
+    reader->block_count = file_status.st_size / header.block_size;
+    reader->block = 1;
+    *pin_mask = header.pin_mask;
+    *trace_reader = reader;
+
+    return SUCCESS;
+}
+
+void seek_gpio_trace(TraceReader* trace_reader, uint64_t timestamp)
+{
+    TraceReader next;
+    uint64_t first;
+    uint64_t last;
+    uint64_t middle;
+    uint64_t keyframe_timestamp;
+
+    // Find the last block whose keyframe is at or before the timestamp (unused blocks sort last)
+    first = 1;
+    last = trace_reader->block_count;
+
+    while(last > first + 1)
+    {
+        middle = first + (last - first) / 2;
+        keyframe_timestamp = get_keyframe_timestamp(trace_reader, middle);
+
+        if(keyframe_timestamp != 0 && keyframe_timestamp <= timestamp)
+        {
+            first = middle;
+        }
+        else
+        {
+            last = middle;
+        }
+    }
+
+    trace_reader->block = first;
+    trace_reader->offset = 0;
+    trace_reader->pending = next_sample(trace_reader);
+
+    if(!trace_reader->pending)
+    {
+        return;
+    }
+
+    // Then decode forward within the block
+    next = *trace_reader;
+
+    while(next_sample(&next) && next.timestamp <= timestamp)
+    {
+        *trace_reader = next;
+    }
+}
+
+size_t read_gpio_trace(TraceReader* trace_reader, CaptureSample* samples, size_t sample_count)
+{
+    size_t count = 0;
+
+    while(count < sample_count)
+    {
+        if(!trace_reader->pending && !next_sample(trace_reader))
+        {
+            break;
+        }
+
+        samples[count].timestamp = trace_reader->timestamp;
+        samples[count].levels = trace_reader->levels;
+        trace_reader->pending = false;
+        count++;
+    }
+
+    return count;
+}
+
+void close_gpio_trace_reader(TraceReader* trace_reader)
+{
+    munmap((void*) trace_reader->memory, trace_reader->memory_size);
+    free(trace_reader);
+}
+
+static bool map_chunk(TraceWriter* trace_writer, uint64_t first_block)
+{
+    void* chunk;
+
+    if(trace_writer->chunk != 0x00)
+    {
+        munmap(trace_writer->chunk, TRACE_GROW_BLOCKS * TRACE_BLOCK_SIZE);
+        trace_writer->chunk = 0x00;
+    }
+
+    if(posix_fallocate(trace_writer->file, first_block * TRACE_BLOCK_SIZE, TRACE_GROW_BLOCKS * TRACE_BLOCK_SIZE) != 0)
+    {
+        return false;
+    }
+
+    chunk = mmap(0x00, TRACE_GROW_BLOCKS * TRACE_BLOCK_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, trace_writer->file, 
+            first_block * TRACE_BLOCK_SIZE);
+
+    if(chunk == MAP_FAILED)
+    {
+        return false;
+    }
+
+    trace_writer->chunk = chunk;
+    trace_writer->chunk_block = first_block;
+
+    return true;
+}
+
+static uint64_t pack_pins(PinMask pins, PinMask pin_mask)
+{
+    uint64_t packed_pins = 0x00;
+    int bit = 0;
+
+    for(; pin_mask != 0; pin_mask &= pin_mask - 1, bit++)
+    {
+        if((pins & pin_mask & -pin_mask) != 0)
+        {
+            packed_pins |= (uint64_t) 1 << bit;
+        }
+    }
+
+    return packed_pins;
+}
+
+static PinMask unpack_pins(uint64_t packed_pins, PinMask pin_mask)
+{
+    PinMask pins = 0x00;
+
+    for(; pin_mask != 0 && packed_pins != 0; pin_mask &= pin_mask - 1, packed_pins >>= 1)
+    {
+        if((packed_pins & 0x01) != 0)
+        {
+            pins |= pin_mask & -pin_mask;
+        }
+    }
+
+    return pins;
+}
+
+static size_t encode_varint(uint64_t value, uint8_t* buffer)
+{
+    size_t size = 0;
+
+    while(value >= VARINT_MORE)
+    {
+        buffer[size++] = (uint8_t) (value | VARINT_MORE);
+        value >>= VARINT_BITS;
+    }
+
+    buffer[size++] = (uint8_t) value;
+
+    return size;
+}
+
+static bool decode_varint(const uint8_t* block, size_t block_size, size_t* offset, uint64_t* value)
+{
+    int shift;
+
+    *value = 0x00;
+
+    for(shift = 0; *offset < block_size && shift < 64; shift += VARINT_BITS)
+    {
+        *value |= (uint64_t) (block[*offset] & ~VARINT_MORE) << shift;
+
+        if((block[(*offset)++] & VARINT_MORE) == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool next_sample(TraceReader* trace_reader)
+{
+    const uint8_t* block;
+    uint64_t changed_pins;
+    uint64_t delta;
+
+    while(trace_reader->block < trace_reader->block_count)
+    {
+        block = trace_reader->memory + trace_reader->block * trace_reader->block_size;
+
+        if(trace_reader->offset == 0)
+        {
+            memcpy(&trace_reader->timestamp, block, sizeof(uint64_t));
+            memcpy(&trace_reader->levels, block + sizeof(uint64_t), sizeof(uint64_t));
+
+            // Blocks allocated ahead by a writer that did not close the file are still zero
+            if(trace_reader->timestamp == 0)
+            {
+                trace_reader->block = trace_reader->block_count;
+                return false;
+            }
+
+            trace_reader->offset = KEYFRAME_SIZE;
+            return true;
+        }
+
+        if(decode_varint(block, trace_reader->block_size, &trace_reader->offset, &changed_pins) && changed_pins != 0 && 
+                decode_varint(block, trace_reader->block_size, &trace_reader->offset, &delta))
+        {
+            trace_reader->levels ^= unpack_pins(changed_pins, trace_reader->pin_mask);
+            trace_reader->timestamp += delta;
+            return true;
+        }
+
+        // End of the block
+        trace_reader->block++;
+        trace_reader->offset = 0;
+    }
+
+    return false;
+}
+
+static uint64_t get_keyframe_timestamp(const TraceReader* trace_reader, uint64_t block)
+{
+    uint64_t timestamp;
+
+    memcpy(&timestamp, trace_reader->memory + block * trace_reader->block_size, sizeof(uint64_t));
+
+    return timestamp;
+}
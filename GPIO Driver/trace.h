@@ -0,0 +1,150 @@
+/*
+ * File:        trace.h
+ * Description: Capture traces recorded as run-length encoded level changes in a memory-mapped file.
+ * Programmer:  tnewman
+ * Date:        Oct 16, 2026
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 Thomas Newman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "gpio.h"
+#include "capture.h"
+
+#include <stddef.h>
+
+/*
+ * Configuration
+ */
+#define TRACE_BLOCK_SIZE 4096 // Bytes per block (a multiple of the page size)
+#define TRACE_GROW_BLOCKS 256 // Blocks added to the file and mapped at a time by the writer
+#define TRACE_FILE_MODE 0644
+
+/*
+ * Trace File Format
+ *
+ * The file is a sequence of TRACE_BLOCK_SIZE blocks. The first block is the header: the magic "PIOTRACE", a 32-bit 
+ * version, the 32-bit block size, and the 64-bit mask of the traced pins (Broadcom numbering), all little-endian. 
+ * Every later block starts with a keyframe, the 64-bit timestamp and 64-bit levels of a sample, followed by records of 
+ * the samples after it. A record is two unsigned LEB128 varints: the pins that changed, packed so that bit n is the 
+ * nth traced pin, and the nanoseconds since the previous sample. A record never has an empty change mask, so a 0x00 
+ * byte (or the end of the block) ends the block, and a block whose keyframe timestamp is 0 ends the trace. Samples 
+ * cost a few bytes each, so the file grows with the activity of the pins rather than with the sample rate, and the 
+ * keyframes allow seeking with a binary search over the blocks.
+ */
+
+/*
+ * Name: TraceWriter
+ * Description: A trace file open for appending. The file is grown and mapped TRACE_GROW_BLOCKS blocks at a time, so 
+ *              writing a sample is a few stores into mapped memory.
+ */
+typedef struct TraceWriter TraceWriter;
+
+/*
+ * Name: TraceReader
+ * Description: A trace file mapped for reading, and the position of the next sample.
+ */
+typedef struct TraceReader TraceReader;
+
+/*
+ * Name: open_gpio_trace_writer
+ * Description: Creates (or replaces) a trace file for the samples of a set of pins.
+ * Parameters:
+ *       file_name[in] - Path of the trace file.
+ *       pin_mask[in] - The traced pins (Broadcom numbering).
+ *       trace_writer[out] - The open writer.
+ * Returns: Result of the operation.
+ */
+StatusCode open_gpio_trace_writer(const char* file_name, PinMask pin_mask, TraceWriter** trace_writer);
+
+/*
+ * Name: write_gpio_trace
+ * Description: Appends samples to a trace (for example the samples drained with read_gpio_capture). Levels of pins 
+ *              that are not traced are ignored, and samples that do not change the traced levels are skipped.
+ * Note: Timestamps must not go backwards.
+ * Parameters:
+ *       trace_writer[in] - The open writer.
+ *       samples[in] - The samples, oldest first.
+ *       sample_count[in] - Number of samples.
+ * Returns: Result of the operation.
+ */
+StatusCode write_gpio_trace(TraceWriter* trace_writer, const CaptureSample* samples, size_t sample_count);
+
+/*
+ * Name: close_gpio_trace_writer
+ * Description: Unmaps a trace file, trims the blocks that were added but not used, and frees the writer.
+ * Parameters:
+ *       trace_writer[in] - The open writer.
+ * Returns: Result of the operation.
+ */
+StatusCode close_gpio_trace_writer(TraceWriter* trace_writer);
+
+/*
+ * Name: open_gpio_trace_reader
+ * Description: Maps a trace file for reading, positioned at its first sample. A file that was not closed (for example 
+ *              after a crash) can be read up to the last sample written.
+ * Parameters:
+ *       file_name[in] - Path of the trace file.
+ *       pin_mask[out] - The traced pins (Broadcom numbering).
+ *       trace_reader[out] - The open reader.
+ * Returns: Result of the operation (UNSUPPORTED if the file is not a trace or is shorter than its header block).
+ */
+StatusCode open_gpio_trace_reader(const char* file_name, PinMask* pin_mask, TraceReader** trace_reader);
+
+/*
+ * Name: seek_gpio_trace
+ * Description: Positions a reader at the last sample at or before a timestamp, so the next sample read holds the 
+ *              levels at that time. Before the first sample, the reader is positioned at the first sample.
+ * Parameters:
+ *       trace_reader[in] - The open reader.
+ *       timestamp[in] - Monotonic clock time in nanoseconds.
+ * Returns: None
+ */
+void seek_gpio_trace(TraceReader* trace_reader, uint64_t timestamp);
+
+/*
+ * Name: read_gpio_trace
+ * Description: Decodes the next samples of a trace.
+ * Parameters:
+ *       trace_reader[in] - The open reader.
+ *       samples[out] - Buffer receiving the samples, oldest first.
+ *       sample_count[in] - Number of samples the buffer can hold.
+ * Returns: Number of samples decoded (less than sample_count at the end of the trace).
+ */
+size_t read_gpio_trace(TraceReader* trace_reader, CaptureSample* samples, size_t sample_count);
+
+/*
+ * Name: close_gpio_trace_reader
+ * Description: Unmaps a trace file and frees the reader.
+ * Parameters:
+ *       trace_reader[in] - The open reader.
+ * Returns: None
+ */
+void close_gpio_trace_reader(TraceReader* trace_reader);
+
+#endif /* TRACE_H_ */
@@ -0,0 +1,257 @@
+/*
+ * File:        transaction.c
+ * Description: GPIO transaction implementation.
+ * Programmer:  tnewman
+ * Date:        Oct 16, 2026
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 Thomas Newman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "transaction.h"
+#include "internal.h"
+
+#include <string.h>
+
+/*
+ * Configuration
+ */
+#define PINS_PER_FUNCTION_REGISTER (REGISTER_SIZE / GPFSEL_BITS_PER_PIN)
+
+/*
+ * Implementation Functions
+ *
+ * These functions are for internal use only.
+ */
+
+/*
+ * Name: stage_function
+ * Description: Stages the function code of a Broadcom pin.
+ * Parameters:
+ *       transaction[in,out] - The transaction.
+ *       broadcom_number[in] - The Broadcom pin.
+ *       function_code[in] - The function code.
+ * Returns: None
+ */
+static void stage_function(GpioTransaction* transaction, int broadcom_number, unsigned int function_code);
+
+/*
+ * Name: stage_levels
+ * Description: Stages the levels of Broadcom pins and makes them outputs unless they have a staged function.
+ * Parameters:
+ *       transaction[in,out] - The transaction.
+ *       broadcom_mask[in] - The Broadcom pins.
+ *       broadcom_values[in] - The levels of the pins.
+ * Returns: None
+ */
+static void stage_levels(GpioTransaction* transaction, PinMask broadcom_mask, PinMask broadcom_values);
+
+/*
+ * Name: write_bank
+ * Description: Writes one bank register if any of its bits are set.
+ * Parameters:
+ *       register_address[in] - The register.
+ *       bits[in] - The bits to write.
+ * Returns: 1 if the register was written, otherwise 0.
+ */
+static int write_bank(unsigned int register_address, unsigned int bits);
+
+StatusCode open_gpio_transaction(PinType pin_type, GpioTransaction* transaction)
+{
+    // Check initialization
+    if(!check_init())
+    {
+        return NO_INIT;
+    }
+
+    memset(transaction, 0x00, sizeof(GpioTransaction));
+    transaction->pin_type = pin_type;
+
+    return SUCCESS;
+}
+
+StatusCode stage_gpio_mode(GpioTransaction* transaction, int pin_number, PinMode pin_mode)
+{
+    int broadcom_number;
+
+    if(!pin_to_broadcom(pin_number, transaction->pin_type, &broadcom_number))
+    {
+        return INVALID_PIN;
+    }
+
+    // Function code must be 0 to 7
+    if(pin_mode < 0 || pin_mode > GPFSEL_BITS)
+    {
+        return REGISTER_FAILURE;
+    }
+
+    stage_function(transaction, broadcom_number, pin_mode);
+
+    return SUCCESS;
+}
+
+StatusCode stage_gpio_pin(GpioTransaction* transaction, int pin_number, int pin_value)
+{
+    int broadcom_number;
+
+    if(!pin_to_broadcom(pin_number, transaction->pin_type, &broadcom_number))
+    {
+        return INVALID_PIN;
+    }
+
+    stage_levels(transaction, (PinMask) 1 << broadcom_number, pin_value ? ~(PinMask) 0x00 : 0x00);
+
+    return SUCCESS;
+}
+
+StatusCode stage_gpio_mask(GpioTransaction* transaction, PinMask pin_mask, PinMask pin_values)
+{
+    PinMask broadcom_mask;
+    PinMask broadcom_values;
+
+    if(!mask_to_broadcom(pin_mask, pin_values, transaction->pin_type, &broadcom_mask, &broadcom_values))
+    {
+        return INVALID_PIN;
+    }
+
+    stage_levels(transaction, broadcom_mask, broadcom_values);
+
+    return SUCCESS;
+}
+
+StatusCode commit_gpio_transaction(GpioTransaction* transaction)
+{
+    PinMask changed;
+    PinMask set_bits;
+    PinMask clear_bits;
+    unsigned int register_address;
+    unsigned int function_value;
+    volatile Register_Type* function_register;
+    int register_number;
+    int writes = 0;
+
+    // Check initialization
+    if(!check_init())
+    {
+        return NO_INIT;
+    }
+
+    // Levels that differ from the last commit (or were never committed)
+    changed = transaction->output_mask & 
+            (~transaction->committed_mask | (transaction->output_values ^ transaction->committed_values));
+    set_bits = changed & transaction->output_values;
+    clear_bits = changed & ~transaction->output_values;
+
+    writes += write_bank(GPSET0, (unsigned int) set_bits);
+    writes += write_bank(GPSET1, (unsigned int) (set_bits >> REGISTER_SIZE));
+    writes += write_bank(GPCLR0, (unsigned int) clear_bits);
+    writes += write_bank(GPCLR1, (unsigned int) (clear_bits >> REGISTER_SIZE));
+
+    transaction->committed_mask |= transaction->output_mask;
+    transaction->committed_values = (transaction->committed_values & ~transaction->output_mask) | 
+            (transaction->output_values & transaction->output_mask);
+
+    // Function select registers whose value changes
+    for(register_number = 0; register_number < TRANSACTION_FUNCTION_REGISTERS; register_number++)
+    {
+        if(transaction->function_masks[register_number] == 0x00 || 
+           (atomic_load_explicit(&function_shadow[register_number], memory_order_relaxed) & 
+            transaction->function_masks[register_number]) == transaction->function_values[register_number])
+        {
+            continue;
+        }
+
+        register_address = GPFSEL0 + register_number * sizeof(Register_Type);
+        function_register = gpio_memory + calculate_offset(register_address);
+
+        lock_register(register_address);
+        function_value = (*function_register & ~transaction->function_masks[register_number]) | 
+                transaction->function_values[register_number];
+        *function_register = function_value;
+        atomic_store_explicit(&function_shadow[register_number], function_value, memory_order_relaxed);
+        unlock_register(register_address);
+
+        writes++;
+    }
+
+    // One barrier orders every write of the commit before whatever the caller does next
+    if(writes > 0)
+    {
+        atomic_thread_fence(memory_order_seq_cst);
+    }
+
+    transaction->register_writes += writes;
+    memset(transaction->function_masks, 0x00, sizeof(transaction->function_masks));
+    memset(transaction->function_values, 0x00, sizeof(transaction->function_values));
+    transaction->output_mask = 0x00;
+    transaction->output_values = 0x00;
+
+    return SUCCESS;
+}
+
+void invalidate_gpio_transaction(GpioTransaction* transaction)
+{
+    transaction->committed_mask = 0x00;
+    transaction->committed_values = 0x00;
+}
+
+static void stage_function(GpioTransaction* transaction, int broadcom_number, unsigned int function_code)
+{
+    int register_number = broadcom_number / PINS_PER_FUNCTION_REGISTER;
+    int bit_offset = (broadcom_number % PINS_PER_FUNCTION_REGISTER) * GPFSEL_BITS_PER_PIN;
+
+    transaction->function_masks[register_number] |= GPFSEL_BITS << bit_offset;
+    transaction->function_values[register_number] = 
+            (transaction->function_values[register_number] & ~(GPFSEL_BITS << bit_offset)) | 
+            (function_code << bit_offset);
+}
+
+static void stage_levels(GpioTransaction* transaction, PinMask broadcom_mask, PinMask broadcom_values)
+{
+    int broadcom_number;
+
+    transaction->output_mask |= broadcom_mask;
+    transaction->output_values = (transaction->output_values & ~broadcom_mask) | (broadcom_values & broadcom_mask);
+
+    for(broadcom_number = 0; broadcom_mask != 0x00; broadcom_number++, broadcom_mask >>= 1)
+    {
+        if((broadcom_mask & 0x01) && ((transaction->function_masks[broadcom_number / PINS_PER_FUNCTION_REGISTER] >> 
+           ((broadcom_number % PINS_PER_FUNCTION_REGISTER) * GPFSEL_BITS_PER_PIN)) & GPFSEL_BITS) == 0x00)
+        {
+            stage_function(transaction, broadcom_number, GPIO_OUTPUT);
+        }
+    }
+}
+
+static int write_bank(unsigned int register_address, unsigned int bits)
+{
+    if(bits == 0x00)
+    {
+        return 0;
+    }
+
+    *(gpio_memory + calculate_offset(register_address)) = bits;
+
+    return 1;
+}
@@ -0,0 +1,130 @@
+/*
+ * File:        transaction.h
+ * Description: Definition of GPIO transactions, which stage pin changes and commit only the register writes that
+ *              change something.
+ * Programmer:  tnewman
+ * Date:        Oct 16, 2026
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 Thomas Newman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef TRANSACTION_H
+#define TRANSACTION_H
+
+#include "gpio.h"
+
+#include <stdint.h>
+
+/*
+ * Configuration
+ */
+#define TRANSACTION_FUNCTION_REGISTERS 6
+
+/*
+ * Name: GpioTransaction
+ * Description: Pin changes staged for the next commit and the output levels of the last commits. Commits compare the 
+ *              staged function codes with the library's copy of the function select registers, and the staged levels 
+ *              with the levels this transaction committed before, so a commit only writes registers that change. A 
+ *              transaction is meant to live as long as the loop that uses it and must only be used by one thread.
+ */
+typedef struct {
+    PinType pin_type; // Numbering convention of the staged pins.
+    unsigned int function_masks[TRANSACTION_FUNCTION_REGISTERS]; // Staged function select fields.
+    unsigned int function_values[TRANSACTION_FUNCTION_REGISTERS]; // Staged function codes.
+    PinMask output_mask; // Pins with a staged level (Broadcom numbering).
+    PinMask output_values; // Staged levels (Broadcom numbering).
+    PinMask committed_mask; // Pins whose level is known from an earlier commit (Broadcom numbering).
+    PinMask committed_values; // Levels of the last commits (Broadcom numbering).
+    uint64_t register_writes; // Register writes made by every commit of the transaction.
+} GpioTransaction;
+
+/*
+ * Name: open_gpio_transaction
+ * Description: Starts a transaction with nothing staged and no committed levels.
+ * Note: Must be called after initialize_gpio.
+ * Parameters:
+ *       pin_type[in] - The numbering convention used to identify the staged pins.
+ *       transaction[out] - The transaction.
+ * Returns: Result of the operation.
+ */
+StatusCode open_gpio_transaction(PinType pin_type, GpioTransaction* transaction);
+
+/*
+ * Name: stage_gpio_mode
+ * Description: Stages a function change of a pin.
+ * Parameters:
+ *       transaction[in,out] - The transaction.
+ *       pin_number[in] - The GPIO pin number.
+ *       pin_mode[in] - The function to give the pin.
+ * Returns: Result of the operation.
+ */
+StatusCode stage_gpio_mode(GpioTransaction* transaction, int pin_number, PinMode pin_mode);
+
+/*
+ * Name: stage_gpio_pin
+ * Description: Stages the level of a pin. Like set_gpio_pin and clear_gpio_pin, the pin is made an output unless a 
+ *              function was staged for it in this transaction.
+ * Parameters:
+ *       transaction[in,out] - The transaction.
+ *       pin_number[in] - The GPIO pin number.
+ *       pin_value[in] - Zero to clear the pin, otherwise set it.
+ * Returns: Result of the operation.
+ */
+StatusCode stage_gpio_pin(GpioTransaction* transaction, int pin_number, int pin_value);
+
+/*
+ * Name: stage_gpio_mask
+ * Description: Stages the levels of every pin in a mask (see stage_gpio_pin).
+ * Parameters:
+ *       transaction[in,out] - The transaction.
+ *       pin_mask[in] - The GPIO pins.
+ *       pin_values[in] - The levels of the pins.
+ * Returns: Result of the operation.
+ */
+StatusCode stage_gpio_mask(GpioTransaction* transaction, PinMask pin_mask, PinMask pin_values);
+
+/*
+ * Name: commit_gpio_transaction
+ * Description: Writes the staged changes and clears them. Levels are written first (at most one GPSET and one GPCLR 
+ *              store per bank, only for pins whose level differs from the last commit), then function select 
+ *              registers whose value changes (one locked read-modify-write each), so a pin that becomes an output 
+ *              starts at its staged level. One memory barrier follows the writes.
+ * Parameters:
+ *       transaction[in,out] - The transaction.
+ * Returns: Result of the operation.
+ */
+StatusCode commit_gpio_transaction(GpioTransaction* transaction);
+
+/*
+ * Name: invalidate_gpio_transaction
+ * Description: Forgets the committed levels, so the next commit writes every staged level. Use it when something 
+ *              other than the transaction may have driven its pins.
+ * Parameters:
+ *       transaction[in,out] - The transaction.
+ * Returns: None
+ */
+void invalidate_gpio_transaction(GpioTransaction* transaction);
+
+#endif /* TRANSACTION_H_ */
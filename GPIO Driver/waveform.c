@@ -0,0 +1,299 @@
+/*
+ * File:        waveform.c
+ * Description: Precompiled waveform implementation.
+ * Programmer:  tnewman
+ * Date:        Oct 16, 2026
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 Thomas Newman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "waveform.h"
+#include "internal.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*
+ * Configuration
+ */
+#define NANOSECONDS_PER_SECOND 1000000000ULL
+#define CALIBRATION_CHUNK 100000
+#define CALIBRATION_STEPS 1000
+
+/*
+ * Name: CompiledStep
+ * Description: One step of a compiled waveform, ready to be written to the registers.
+ */
+typedef struct {
+    unsigned int set_bits[2]; // Values stored to GPSET0 and GPSET1.
+    unsigned int clear_bits[2]; // Values stored to GPCLR0 and GPCLR1.
+    unsigned long delay; // Iterations of the delay loop after the stores.
+} CompiledStep;
+
+/*
+ * Name: Waveform
+ * Description: The compiled steps and whether any of them touch the second bank.
+ */
+struct Waveform {
+    int step_count;
+    bool both_banks;
+    CompiledStep steps[];
+};
+
+/*
+ * Global Variables
+ */
+static double delay_loops_per_microsecond = 0.0; // Calibration of the delay loop
+static double step_overhead[2] = {0.0, 0.0}; // Nanoseconds taken by the stores of one step (one bank, both banks)
+
+/*
+ * Implementation Functions
+ *
+ * These functions are for internal use only.
+ */
+
+/*
+ * Name: delay_loop
+ * Description: Spins for a number of iterations. The empty assembly statement keeps the compiler from removing the 
+ *              loop, and the function is never inlined so calibration and playback run the same code.
+ * Parameters:
+ *       iterations[in] - Number of iterations to spin for.
+ * Returns: None
+ */
+static void __attribute__((noinline)) delay_loop(unsigned long iterations);
+
+/*
+ * Name: play_steps
+ * Description: Writes a run of compiled steps to the registers, each followed by its delay. Shared by playback and 
+ *              calibration, so the measured overhead of a step is the overhead of the real loop.
+ * Parameters:
+ *       steps[in] - The first step to play.
+ *       end[in] - One past the last step to play.
+ *       both_banks[in] - Whether the second bank is written too.
+ * Returns: None
+ */
+static void play_steps(const CompiledStep* steps, const CompiledStep* end, bool both_banks);
+
+/*
+ * Name: measure_step_overhead
+ * Description: Plays steps that change no pins and have no delay for WAVEFORM_CALIBRATION_TIME nanoseconds.
+ * Parameters:
+ *       both_banks[in] - Whether the second bank is written too.
+ * Returns: Nanoseconds taken by one step without its delay.
+ */
+static double measure_step_overhead(bool both_banks);
+
+/*
+ * Name: get_nanoseconds
+ * Description: Reads the monotonic clock.
+ * Parameters: None
+ * Returns: The current time in nanoseconds.
+ */
+static unsigned long long get_nanoseconds();
+
+void calibrate_gpio_waveform()
+{
+    unsigned long long start;
+    unsigned long long elapsed;
+    unsigned long iterations = 0;
+
+    start = get_nanoseconds();
+
+    do
+    {
+        delay_loop(CALIBRATION_CHUNK);
+        iterations += CALIBRATION_CHUNK;
+        elapsed = get_nanoseconds() - start;
+    }
+    while(elapsed < WAVEFORM_CALIBRATION_TIME);
+
+    delay_loops_per_microsecond = iterations * 1000.0 / elapsed;
+
+    // The stores cannot be timed until the registers are mapped; compiling measures them then
+    if(check_init())
+    {
+        step_overhead[0] = measure_step_overhead(false);
+        step_overhead[1] = measure_step_overhead(true);
+    }
+}
+
+StatusCode compile_gpio_waveform(const WaveformStep* waveform_steps, int step_count, PinType pin_type, 
+        Waveform** waveform)
+{
+    Waveform* compiled;
+    PinMask broadcom_mask;
+    PinMask broadcom_values;
+    PinMask pin_mask = 0x00;
+    PinMask bits;
+    double delay;
+    int i;
+
+    // Check initialization
+    if(!check_init())
+    {
+        return NO_INIT;
+    }
+
+    if(step_count <= 0)
+    {
+        return UNSUPPORTED;
+    }
+
+    if(delay_loops_per_microsecond == 0.0 || step_overhead[0] == 0.0)
+    {
+        calibrate_gpio_waveform();
+    }
+
+    compiled = malloc(sizeof(Waveform) + step_count * sizeof(CompiledStep));
+
+    if(compiled == 0x00)
+    {
+        return REGISTER_FAILURE;
+    }
+
+    compiled->step_count = step_count;
+    compiled->both_banks = false;
+
+    // All of the validation and lookups happen here, once
+    for(i = 0; i < step_count; i++)
+    {
+        if(!mask_to_broadcom(waveform_steps[i].pin_mask, waveform_steps[i].pin_values, pin_type, &broadcom_mask, 
+                &broadcom_values))
+        {
+            free(compiled);
+            return INVALID_PIN;
+        }
+
+        bits = broadcom_mask & broadcom_values;
+        compiled->steps[i].set_bits[0] = (unsigned int) bits;
+        compiled->steps[i].set_bits[1] = (unsigned int) (bits >> REGISTER_SIZE);
+
+        bits = broadcom_mask & ~broadcom_values;
+        compiled->steps[i].clear_bits[0] = (unsigned int) bits;
+        compiled->steps[i].clear_bits[1] = (unsigned int) (bits >> REGISTER_SIZE);
+
+        pin_mask |= broadcom_mask;
+    }
+
+    compiled->both_banks = (pin_mask >> REGISTER_SIZE) != 0;
+
+    // The stores of each step take time too, so only the rest of the duration is spent in the delay loop
+    for(i = 0; i < step_count; i++)
+    {
+        delay = waveform_steps[i].duration - step_overhead[compiled->both_banks];
+        compiled->steps[i].delay = delay > 0.0 ? (unsigned long) (delay * delay_loops_per_microsecond / 1000.0) : 0;
+    }
+
+    if(!set_gpio_mask_function(pin_mask, GPIO_OUTPUT))
+    {
+        free(compiled);
+        return REGISTER_FAILURE;
+    }
+
+    *waveform = compiled;
+
+    return SUCCESS;
+}
+
+void play_gpio_waveform(const Waveform* waveform, int repeat_count)
+{
+    while(repeat_count-- > 0)
+    {
+        play_steps(waveform->steps, waveform->steps + waveform->step_count, waveform->both_banks);
+    }
+}
+
+void free_gpio_waveform(Waveform* waveform)
+{
+    free(waveform);
+}
+
+static void __attribute__((noinline)) delay_loop(unsigned long iterations)
+{
+    while(iterations-- > 0)
+    {
+        __asm__ volatile("");
+    }
+}
+
+static void play_steps(const CompiledStep* steps, const CompiledStep* end, bool both_banks)
+{
+    volatile Register_Type* set_register = gpio_memory + calculate_offset(GPSET0);
+    volatile Register_Type* clear_register = gpio_memory + calculate_offset(GPCLR0);
+    const CompiledStep* step;
+
+    // Every step costs the same number of stores, so the timing does not depend on which pins change
+    if(both_banks)
+    {
+        for(step = steps; step != end; step++)
+        {
+            set_register[0] = step->set_bits[0];
+            set_register[1] = step->set_bits[1];
+            clear_register[0] = step->clear_bits[0];
+            clear_register[1] = step->clear_bits[1];
+            delay_loop(step->delay);
+        }
+    }
+    else
+    {
+        for(step = steps; step != end; step++)
+        {
+            set_register[0] = step->set_bits[0];
+            clear_register[0] = step->clear_bits[0];
+            delay_loop(step->delay);
+        }
+    }
+}
+
+static double measure_step_overhead(bool both_banks)
+{
+    // Writing zero to the set and clear registers leaves every pin as it is
+    static const CompiledStep idle_steps[CALIBRATION_STEPS];
+    unsigned long long start;
+    unsigned long long elapsed;
+    unsigned long steps = 0;
+
+    start = get_nanoseconds();
+
+    do
+    {
+        play_steps(idle_steps, idle_steps + CALIBRATION_STEPS, both_banks);
+        steps += CALIBRATION_STEPS;
+        elapsed = get_nanoseconds() - start;
+    }
+    while(elapsed < WAVEFORM_CALIBRATION_TIME);
+
+    return (double) elapsed / steps;
+}
+
+static unsigned long long get_nanoseconds()
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return time.tv_sec * NANOSECONDS_PER_SECOND + time.tv_nsec;
+}
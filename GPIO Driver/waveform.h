@@ -0,0 +1,108 @@
+/*
+ * File:        waveform.h
+ * Description: Definition of the precompiled waveform functions and data types.
+ * Programmer:  tnewman
+ * Date:        Oct 16, 2026
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 Thomas Newman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef WAVEFORM_H
+#define WAVEFORM_H
+
+#include "gpio.h"
+
+/*
+ * Configuration
+ */
+#define WAVEFORM_CALIBRATION_TIME 20000000
+
+/*
+ * Name: WaveformStep
+ * Description: One step of a waveform description: drive some pins to new levels, then hold for a while.
+ */
+typedef struct {
+    PinMask pin_mask; // The pins changed by this step.
+    PinMask pin_values; // The levels the changed pins are driven to.
+    unsigned int duration; // Time to hold the levels before the next step, in nanoseconds.
+} WaveformStep;
+
+/*
+ * Name: Waveform
+ * Description: A compiled waveform: a flat array of set masks, clear masks, and spin counts that is played back 
+ *              without any lookups or validation.
+ */
+typedef struct Waveform Waveform;
+
+/*
+ * Name: calibrate_gpio_waveform
+ * Description: Measures how many iterations of the delay loop run per microsecond, and how long the stores of one 
+ *              step take, each over WAVEFORM_CALIBRATION_TIME nanoseconds. compile_gpio_waveform calibrates 
+ *              automatically the first time, so this is only needed to calibrate again (for example after the CPU 
+ *              frequency has been changed).
+ * Note: The stores are only measured after initialize_gpio; they write zero, so no pin changes.
+ * Parameters: None
+ * Returns: None
+ */
+void calibrate_gpio_waveform();
+
+/*
+ * Name: compile_gpio_waveform
+ * Description: Validates a waveform description once, switches its pins to output mode, and compiles it into a 
+ *              waveform that can be played many times.
+ * Note: Must be called after initialize_gpio. Delays are converted to spin counts with the current calibration, so 
+ *       compile again after calibrating again.
+ * Parameters:
+ *       waveform_steps[in] - The steps of the waveform.
+ *       step_count[in] - Number of steps.
+ *       pin_type[in] - The numbering convention used by the pin masks of the steps.
+ *       waveform[out] - The compiled waveform.
+ * Returns: Result of the operation. UNSUPPORTED if there are no steps.
+ */
+StatusCode compile_gpio_waveform(const WaveformStep* waveform_steps, int step_count, PinType pin_type, 
+        Waveform** waveform);
+
+/*
+ * Name: play_gpio_waveform
+ * Description: Plays a compiled waveform in a tight loop with busy-wait delays.
+ * Note: No checks are made. The library must still be initialized. The loop does not sleep, so run it on a thread 
+ *       prepared for real-time work for the best timing.
+ * Parameters:
+ *       waveform[in] - The compiled waveform.
+ *       repeat_count[in] - Number of times to play the waveform.
+ * Returns: None
+ */
+void play_gpio_waveform(const Waveform* waveform, int repeat_count);
+
+/*
+ * Name: free_gpio_waveform
+ * Description: Frees a compiled waveform.
+ * Parameters:
+ *       waveform[in] - The compiled waveform.
+ * Returns: None
+ */
+void free_gpio_waveform(Waveform* waveform);
+
+#endif /* WAVEFORM_H_ */
@@ -0,0 +1,83 @@
+/*
+ * File:        check.h
+ * Description: Failure counting shared by the tests.
+ * Programmer:  tnewman
+ * Date:        Oct 16, 2026
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 Thomas Newman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Global Variables
+ */
+static int check_failures = 0; // Number of checks that failed in this test
+
+/*
+ * Name: check
+ * Description: Counts and reports a failed check.
+ * Parameters:
+ *       passed[in] - The result of the check.
+ *       format[in] - printf format describing what was checked, followed by its arguments.
+ * Returns: None
+ */
+static inline void __attribute__((format(printf, 2, 3))) check(bool passed, const char* format, ...)
+{
+    va_list arguments;
+
+    if(!passed)
+    {
+        va_start(arguments, format);
+        fprintf(stderr, "FAILED: ");
+        vfprintf(stderr, format, arguments);
+        fprintf(stderr, "\n");
+        va_end(arguments);
+        check_failures++;
+    }
+}
+
+/*
+ * Name: finish_checks
+ * Description: Prints the number of failed checks.
+ * Parameters:
+ *       test_name[in] - What the test checked.
+ * Returns: The exit status of the test.
+ */
+static inline int finish_checks(const char* test_name)
+{
+    printf("%s checks: %d failures\n", test_name, check_failures);
+
+    return check_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#endif /* CHECK_H_ */
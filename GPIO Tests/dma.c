@@ -0,0 +1,141 @@
+/*
+ * File:        dma.c
+ * Description: Steps the control block chain of a DMA waveform through the simulated DMA engine and checks the
+ *              outputs and pacing ticks of every step.
+ * Programmer:  tnewman
+ * Date:        Oct 16, 2026
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 Thomas Newman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "gpio.h"
+#include "dma.h"
+#include "simulator.h"
+#include "check.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Configuration
+ */
+#define TICK 1000 // Nanoseconds per pacing tick
+#define LOW_PIN ((PinMask) 1 << 4) // A pin in the first bank
+#define HIGH_PIN ((PinMask) 1 << 40) // A pin in the second bank
+#define LONG_TICKS (DMA_PACING_TICKS_MAX + 3617) // Needs a second pacing control block
+
+/*
+ * Name: ExpectedStep
+ * Description: The result of one call to step_simulated_dma.
+ */
+typedef struct {
+    PinMask pin_values; // The outputs after the control blocks ran.
+    unsigned int ticks; // The pacing ticks waited for.
+} ExpectedStep;
+
+/*
+ * The waveform: both banks high, both low for longer than one pacing control block, then the first bank alone high
+ * for a duration that rounds down to one tick.
+ */
+const WaveformStep STEPS[] = {
+    {LOW_PIN | HIGH_PIN, LOW_PIN | HIGH_PIN, 3 * TICK},
+    {LOW_PIN | HIGH_PIN, 0x00, LONG_TICKS * TICK},
+    {LOW_PIN, LOW_PIN, TICK + TICK / 2 - 1}
+};
+
+/*
+ * One pass over the chain: the long step is split into a full pacing control block and the rest.
+ */
+const ExpectedStep EXPECTED[] = {
+    {LOW_PIN | HIGH_PIN, 3},
+    {0x00, DMA_PACING_TICKS_MAX},
+    {0x00, LONG_TICKS - DMA_PACING_TICKS_MAX},
+    {LOW_PIN, 1}
+};
+
+#define EXPECTED_COUNT (int) (sizeof(EXPECTED) / sizeof(EXPECTED[0]))
+
+/*
+ * Name: check_pass
+ * Description: Steps through one pass over the chain and checks the outputs and ticks of every step.
+ * Parameters:
+ *       dma_waveform[in] - The started waveform.
+ * Returns: None
+ */
+static void check_pass(const DmaWaveform* dma_waveform)
+{
+    PinMask pin_values;
+    unsigned int ticks;
+    int i;
+
+    for(i = 0; i < EXPECTED_COUNT; i++)
+    {
+        check(check_gpio_dma_waveform(dma_waveform), "the waveform is playing (step %d)", i);
+        check(step_simulated_dma(dma_waveform, &pin_values, &ticks) == SUCCESS, "step_simulated_dma succeeds (step %d)",
+                i);
+        check((pin_values & (LOW_PIN | HIGH_PIN)) == EXPECTED[i].pin_values, "outputs (step %d)", i);
+        check(ticks == EXPECTED[i].ticks, "ticks (step %d)", i);
+    }
+}
+
+int main()
+{
+    DmaWaveform* dma_waveform;
+    PinMask pin_values;
+    unsigned int ticks;
+
+    if(initialize_gpio_backend(SIMULATED_BACKEND) != SUCCESS)
+    {
+        fprintf(stderr, "Cannot initialize the simulated registers\n");
+        return EXIT_FAILURE;
+    }
+
+    if(compile_gpio_dma_waveform(STEPS, sizeof(STEPS) / sizeof(STEPS[0]), BROADCOM, TICK, &dma_waveform) != SUCCESS)
+    {
+        fprintf(stderr, "Cannot compile the waveform\n");
+        finalize_gpio();
+        return EXIT_FAILURE;
+    }
+
+    // Played once, the channel ends with the last control block
+    check(start_gpio_dma_waveform(dma_waveform, DMA_DEFAULT_CHANNEL, false) == SUCCESS, "start once");
+    check_pass(dma_waveform);
+    check(!check_gpio_dma_waveform(dma_waveform), "the waveform has ended");
+    check(step_simulated_dma(dma_waveform, &pin_values, &ticks) == UNSUPPORTED, "an ended channel does not step");
+
+    // Repeated, the last control block leads back to the first
+    check(start_gpio_dma_waveform(dma_waveform, DMA_DEFAULT_CHANNEL, true) == SUCCESS, "start repeating");
+    check_pass(dma_waveform);
+    check_pass(dma_waveform);
+    check(check_gpio_dma_waveform(dma_waveform), "the repeating waveform is still playing");
+    check(stop_gpio_dma_waveform(dma_waveform) == SUCCESS, "stop");
+    check(!check_gpio_dma_waveform(dma_waveform), "the stopped waveform is not playing");
+
+    free_gpio_dma_waveform(dma_waveform);
+    finalize_gpio();
+
+    return finish_checks("DMA waveform");
+}
@@ -0,0 +1,119 @@
+/*
+ * File:        hpp.cpp
+ * Description: Compiles gpio.hpp and checks its pins, pin groups and layouts against the simulated registers.
+ * Programmer:  tnewman
+ * Date:        Oct 16, 2026
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 Thomas Newman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "gpio.hpp"
+#include "check.h"
+
+extern "C"
+{
+#include "simulator.h"
+}
+
+#include <cstdio>
+#include <cstdlib>
+
+/*
+ * Pins that do not depend on the board revision resolve without a layout
+ */
+static_assert(pio::Pin<pio::P1, 11>::broadcom_number == 17, "P1 pin 11 is GPIO17 on every revision");
+static_assert(pio::Pin<pio::Broadcom, 40>::bank == 1, "GPIO40 is in the second bank");
+static_assert(!pio::pin_exists<pio::P1, 3>, "P1 pin 3 depends on the revision");
+static_assert(!pio::pin_exists<pio::P1, 40, pio::Layout::Revision1>, "P1 pin 40 is not on the 26 pin header");
+static_assert(pio::pin_exists<pio::P1, 40, pio::Layout::Header40>, "P1 pin 40 is on the 40 pin header");
+
+using Low = pio::Pin<pio::Broadcom, 4>;
+using High = pio::Pin<pio::Broadcom, 40>;
+using Group = pio::PinGroup<Low, High>;
+
+/*
+ * Name: check_outputs
+ * Description: Checks the simulated outputs of the pins used by the test.
+ * Parameters:
+ *       pin_values[in] - The expected outputs.
+ *       description[in] - What was checked.
+ * Returns: None
+ */
+static void check_outputs(PinMask pin_values, const char* description)
+{
+    PinMask current_values;
+
+    check(get_simulated_outputs(&current_values) == SUCCESS &&
+            (current_values & (Group::bits | ((PinMask) 1 << 2) | ((PinMask) 1 << 21))) == pin_values,
+            "%s", description);
+}
+
+int main()
+{
+    int header_40_calls = 0;
+
+    if(pio::initialize(SIMULATED_BACKEND) != SUCCESS)
+    {
+        fprintf(stderr, "Cannot initialize the simulated registers\n");
+        return EXIT_FAILURE;
+    }
+
+    check(Group::output() == SUCCESS, "the group becomes outputs");
+
+    Low::set();
+    check_outputs(Low::bit, "Pin::set");
+
+    Group::write(0x02);
+    check_outputs(High::bit, "PinGroup::write scatters its bits to its pins");
+
+    Group::clear();
+    check_outputs(0x00, "PinGroup::clear");
+
+    // Instantiated for every layout: the 40 pin header only pin must not break the layouts without it
+    check(pio::with_layout([&](auto layout) {
+        using Sda = pio::Pin<pio::P1, 3, decltype(layout)::value>;
+
+        Sda::output();
+        Sda::set();
+
+        if constexpr(pio::pin_exists<pio::P1, 40, decltype(layout)::value>)
+        {
+            using Led = pio::Pin<pio::P1, 40, decltype(layout)::value>;
+
+            Led::output();
+            Led::set();
+            header_40_calls++;
+        }
+
+        return decltype(layout)::value;
+    }) == pio::Layout::Revision2, "with_layout passes the simulated revision");
+
+    check(header_40_calls == 0, "the 40 pin header branch does not run on a 26 pin header");
+    check_outputs((PinMask) 1 << 2, "P1 pin 3 is GPIO2 on revision 2");
+
+    pio::finalize();
+
+    return finish_checks("C++ header");
+}
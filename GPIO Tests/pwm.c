@@ -0,0 +1,151 @@
+/*
+ * File:        pwm.c
+ * Description: Checks the PWM and general purpose clock registers programmed by pwm.h against the simulated
+ *              registers.
+ * Programmer:  tnewman
+ * Date:        Oct 16, 2026
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 Thomas Newman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "gpio.h"
+#include "pwm.h"
+#include "register.h"
+#include "simulator.h"
+#include "check.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Configuration
+ */
+#define PWM_PIN 18 // PWM channel 0 in ALT5
+#define CLOCK_PIN 4 // GPCLK0 in ALT0
+#define PLAIN_PIN 2 // Neither PWM nor a general purpose clock
+
+/*
+ * Name: check_pin_mode
+ * Description: Checks the mode of a Broadcom pin.
+ * Parameters:
+ *       broadcom_number[in] - The pin to check.
+ *       pin_mode[in] - The expected mode.
+ *       description[in] - What was checked.
+ * Returns: None
+ */
+static void check_pin_mode(int broadcom_number, PinMode pin_mode, const char* description)
+{
+    PinMode current_mode;
+
+    check(get_gpio_pin_mode(broadcom_number, BROADCOM, &current_mode) == SUCCESS && current_mode == pin_mode,
+            "%s", description);
+}
+
+/*
+ * Name: check_cleared_output
+ * Description: Drives a pin high, runs a stop function, and checks that the pin is left as a low output.
+ * Parameters:
+ *       broadcom_number[in] - The pin to check.
+ *       status[in] - The status returned by the stop function.
+ *       description[in] - What was checked.
+ * Returns: None
+ */
+static void check_cleared_output(int broadcom_number, StatusCode status, const char* description)
+{
+    PinMask pin_values;
+
+    check(status == SUCCESS, "%s", description);
+    check_pin_mode(broadcom_number, MODE_OUTPUT, description);
+    check(get_simulated_outputs(&pin_values) == SUCCESS && (pin_values & ((PinMask) 1 << broadcom_number)) == 0,
+            "%s", description);
+}
+
+int main()
+{
+    volatile unsigned int* pwm_registers;
+    volatile unsigned int* clock_registers;
+
+    if(initialize_gpio_backend(SIMULATED_BACKEND) != SUCCESS)
+    {
+        fprintf(stderr, "Cannot initialize the simulated registers\n");
+        return EXIT_FAILURE;
+    }
+
+    pwm_registers = get_gpio_peripheral_registers(PWM_REGION);
+    clock_registers = get_gpio_peripheral_registers(CLOCK_REGION);
+
+    if(pwm_registers == 0x00 || clock_registers == 0x00)
+    {
+        fprintf(stderr, "The simulated backend did not map the PWM and clock registers\n");
+        finalize_gpio();
+        return EXIT_FAILURE;
+    }
+
+    // Start from a high output, so stopping has to clear it
+    set_gpio_pin_mode(PWM_PIN, BROADCOM, MODE_OUTPUT);
+    set_gpio_pin(PWM_PIN, BROADCOM);
+    set_gpio_pin_mode(CLOCK_PIN, BROADCOM, MODE_OUTPUT);
+    set_gpio_pin(CLOCK_PIN, BROADCOM);
+    update_simulated_gpio();
+
+    // 9.6 MHz PWM clock: 1 kHz is a range of 9600, and a quarter duty cycle is 2400 of it
+    check(set_gpio_hardware_pwm(PWM_PIN, BROADCOM, 1000, 250000) == SUCCESS, "set_gpio_hardware_pwm succeeds");
+    check(pwm_registers[calculate_region_offset(PWM_CTL, PWM_MEMORY_START)] == (PWM_PWEN1 | PWM_MSEN1),
+            "CTL enables channel 0 in mark-space mode");
+    check(pwm_registers[calculate_region_offset(PWM_RNG1, PWM_MEMORY_START)] == 9600, "RNG1 is 9600");
+    check(pwm_registers[calculate_region_offset(PWM_DAT1, PWM_MEMORY_START)] == 2400, "DAT1 is 2400");
+    check_pin_mode(PWM_PIN, MODE_ALT5, "GPIO18 is routed to PWM channel 0");
+
+    check_cleared_output(PWM_PIN, stop_gpio_hardware_pwm(PWM_PIN, BROADCOM), "stopping PWM leaves a low output");
+    check((pwm_registers[calculate_region_offset(PWM_CTL, PWM_MEMORY_START)] & PWM_PWEN1) == 0,
+            "stopping PWM disables channel 0");
+
+    // 1 MHz does not divide the 19.2 MHz oscillator, but PLLD (500 MHz) divides down to it exactly
+    check(start_gpio_clock(CLOCK_PIN, BROADCOM, 1000000) == SUCCESS, "start_gpio_clock succeeds");
+    check((clock_registers[calculate_region_offset(CM_GP0CTL, CM_MEMORY_START)] & CM_SRC_BITS) == CM_SRC_PLLD,
+            "GPCLK0 runs from PLLD");
+    check((clock_registers[calculate_region_offset(CM_GP0CTL, CM_MEMORY_START)] & CM_ENAB) != 0,
+            "GPCLK0 is enabled");
+    check(clock_registers[calculate_region_offset(CM_GP0DIV, CM_MEMORY_START)] ==
+            (CM_PASSWORD | (500 << CM_DIVI_SHIFT)), "GPCLK0 divides by 500 without a fraction");
+    check_pin_mode(CLOCK_PIN, MODE_ALT0, "GPIO4 is routed to GPCLK0");
+
+    check_cleared_output(CLOCK_PIN, stop_gpio_clock(CLOCK_PIN, BROADCOM), "stopping GPCLK0 leaves a low output");
+    check((clock_registers[calculate_region_offset(CM_GP0CTL, CM_MEMORY_START)] & CM_ENAB) == 0,
+            "stopping GPCLK0 disables it");
+
+    // Pins without the peripheral and frequencies no source divides down to are refused without touching the pin
+    check(set_gpio_hardware_pwm(PLAIN_PIN, BROADCOM, 1000, 250000) == UNSUPPORTED,
+            "a pin without PWM is UNSUPPORTED");
+    check(start_gpio_clock(PLAIN_PIN, BROADCOM, 1000000) == UNSUPPORTED,
+            "a pin without a general purpose clock is UNSUPPORTED");
+    check(start_gpio_clock(CLOCK_PIN, BROADCOM, 1) == UNSUPPORTED, "a 1 Hz general purpose clock is UNSUPPORTED");
+    check_pin_mode(CLOCK_PIN, MODE_OUTPUT, "a refused clock leaves the pin alone");
+
+    finalize_gpio();
+
+    return finish_checks("PWM and clock");
+}
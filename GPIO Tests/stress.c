@@ -0,0 +1,176 @@
+/*
+ * File:        stress.c
+ * Description: Multi-threaded stress test of the pin mode locking against the simulated registers.
+ * Programmer:  tnewman
+ * Date:        Oct 16, 2026
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 Thomas Newman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "gpio.h"
+#include "internal.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Configuration
+ */
+#define THREAD_COUNT 4
+#define ITERATIONS 2000000
+#define STRESS_PIN_COUNT 20
+
+/*
+ * Pin modes cycled through by every thread.
+ */
+const PinMode MODES[] = {MODE_INPUT, MODE_OUTPUT, MODE_ALT0, MODE_ALT1, MODE_ALT2, MODE_ALT3, MODE_ALT4, MODE_ALT5};
+
+/*
+ * Global Variables
+ */
+atomic_int failures = 0; // Number of checks that failed
+
+/*
+ * Name: get_register_mode
+ * Description: Reads the mode of a Broadcom pin straight from the function select registers.
+ * Parameters:
+ *       broadcom_number[in] - The Broadcom pin to read the mode of.
+ * Returns: The mode of the pin.
+ */
+static int get_register_mode(int broadcom_number)
+{
+    int pins_per_register = REGISTER_SIZE / GPFSEL_BITS_PER_PIN;
+
+    return (gpio_memory[calculate_offset(GPFSEL0) + broadcom_number / pins_per_register] >> 
+            ((broadcom_number % pins_per_register) * GPFSEL_BITS_PER_PIN)) & GPFSEL_BITS;
+}
+
+/*
+ * Name: check_mode
+ * Description: Counts a failure if the mode of a pin in the registers is not the expected mode.
+ * Parameters:
+ *       broadcom_number[in] - The Broadcom pin to check.
+ *       pin_mode[in] - The expected mode.
+ * Returns: None
+ */
+static void check_mode(int broadcom_number, PinMode pin_mode)
+{
+    if(get_register_mode(broadcom_number) != (int) pin_mode)
+    {
+        atomic_fetch_add(&failures, 1);
+    }
+}
+
+/*
+ * Name: run_thread
+ * Description: Changes the modes of the pins owned by one thread over and over. The pins of every thread share the 
+ *              same function select registers, so a lost read-modify-write shows up as a pin with the wrong mode.
+ * Parameters:
+ *       argument[in] - The thread number.
+ * Returns: Always 0x00.
+ */
+static void* run_thread(void* argument)
+{
+    int thread_number = (int) (long) argument;
+    PinMask owned_pins = 0x00;
+    PinMode pin_mode;
+    int iteration;
+    int broadcom_number;
+
+    for(broadcom_number = thread_number; broadcom_number < STRESS_PIN_COUNT; broadcom_number += THREAD_COUNT)
+    {
+        owned_pins |= (PinMask) 1 << broadcom_number;
+    }
+
+    for(iteration = 0; iteration < ITERATIONS; iteration++)
+    {
+        pin_mode = MODES[(iteration + thread_number) % (sizeof(MODES) / sizeof(MODES[0]))];
+
+        // Alternate between single pin changes, mask changes, and the data path
+        switch(iteration % 3)
+        {
+        case 0:
+            for(broadcom_number = thread_number; broadcom_number < STRESS_PIN_COUNT; broadcom_number += THREAD_COUNT)
+            {
+                set_gpio_pin_mode(broadcom_number, BROADCOM, pin_mode);
+            }
+            break;
+        case 1:
+            set_gpio_mask_mode(owned_pins, BROADCOM, pin_mode);
+            break;
+        default:
+            set_gpio_mask(owned_pins, BROADCOM);
+            pin_mode = MODE_OUTPUT;
+            break;
+        }
+
+        for(broadcom_number = thread_number; broadcom_number < STRESS_PIN_COUNT; broadcom_number += THREAD_COUNT)
+        {
+            check_mode(broadcom_number, pin_mode);
+        }
+    }
+
+    return 0x00;
+}
+
+int main()
+{
+    pthread_t threads[THREAD_COUNT];
+    int register_number;
+    long i;
+
+    if(initialize_gpio_backend(SIMULATED_BACKEND) != SUCCESS)
+    {
+        fprintf(stderr, "Cannot initialize the simulated registers\n");
+        return EXIT_FAILURE;
+    }
+
+    for(i = 0; i < THREAD_COUNT; i++)
+    {
+        pthread_create(&threads[i], 0x00, run_thread, (void*) i);
+    }
+
+    for(i = 0; i < THREAD_COUNT; i++)
+    {
+        pthread_join(threads[i], 0x00);
+    }
+
+    // The shadow copy must still match the registers
+    for(register_number = 0; register_number < GPFSEL_REGISTER_COUNT; register_number++)
+    {
+        if(atomic_load(&function_shadow[register_number]) != gpio_memory[calculate_offset(GPFSEL0) + register_number])
+        {
+            atomic_fetch_add(&failures, 1);
+        }
+    }
+
+    finalize_gpio();
+
+    printf("%d threads, %d iterations each: %d failures\n", THREAD_COUNT, ITERATIONS, atomic_load(&failures));
+
+    return atomic_load(&failures) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
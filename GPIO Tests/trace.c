@@ -0,0 +1,231 @@
+/*
+ * File:        trace.c
+ * Description: Writes a trace file that spans many blocks, then reads it back and seeks in it.
+ * Programmer:  tnewman
+ * Date:        Oct 16, 2026
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 Thomas Newman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "trace.h"
+#include "check.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/*
+ * Configuration
+ */
+#define SAMPLE_COUNT 20000 // Enough changes to fill several blocks
+#define SEEK_STRIDE 997 // Samples between the seeks that are checked
+#define FIRST_TIMESTAMP 1000000
+#define TRACED_PINS (((PinMask) 1 << 4) | ((PinMask) 1 << 17) | ((PinMask) 1 << 40))
+
+/*
+ * Global Variables
+ */
+CaptureSample samples[SAMPLE_COUNT]; // The samples written, each changing one traced pin
+
+/*
+ * Name: check_next
+ * Description: Reads one sample and checks that it is the expected one.
+ * Parameters:
+ *       trace_reader[in] - The open reader.
+ *       expected[in] - The expected sample.
+ *       description[in] - What was checked.
+ * Returns: None
+ */
+static void check_next(TraceReader* trace_reader, const CaptureSample* expected, const char* description)
+{
+    CaptureSample sample;
+
+    check(read_gpio_trace(trace_reader, &sample, 1) == 1 && sample.timestamp == expected->timestamp &&
+            sample.levels == expected->levels, "%s", description);
+}
+
+/*
+ * Name: make_samples
+ * Description: Fills the samples so that every sample toggles one of the traced pins, at uneven intervals.
+ * Parameters: None
+ * Returns: None
+ */
+static void make_samples()
+{
+    const PinMask pins[] = {(PinMask) 1 << 4, (PinMask) 1 << 17, (PinMask) 1 << 40};
+    uint64_t timestamp = FIRST_TIMESTAMP;
+    PinMask levels = 0x00;
+    int i;
+
+    for(i = 0; i < SAMPLE_COUNT; i++)
+    {
+        samples[i].timestamp = timestamp;
+        samples[i].levels = levels;
+        levels ^= pins[i % 3];
+        timestamp += 2 + (i % 13) * 1000 + (i % 5) * 100000;
+    }
+}
+
+/*
+ * Name: write_trace
+ * Description: Writes the samples to a trace file in uneven batches, with a repeated sample (which changes nothing)
+ *              after every batch.
+ * Parameters:
+ *       file_name[in] - Path of the trace file.
+ * Returns: true on success, otherwise false.
+ */
+static bool write_trace(const char* file_name)
+{
+    TraceWriter* trace_writer;
+    CaptureSample repeated;
+    int written = 0;
+    int batch;
+
+    if(open_gpio_trace_writer(file_name, TRACED_PINS, &trace_writer) != SUCCESS)
+    {
+        return false;
+    }
+
+    for(batch = 1; written < SAMPLE_COUNT; batch = batch % 251 + 1)
+    {
+        batch = batch < SAMPLE_COUNT - written ? batch : SAMPLE_COUNT - written;
+
+        if(write_gpio_trace(trace_writer, samples + written, batch) != SUCCESS)
+        {
+            close_gpio_trace_writer(trace_writer);
+            return false;
+        }
+
+        written += batch;
+        repeated = samples[written - 1];
+        repeated.timestamp++;
+
+        if(written < SAMPLE_COUNT && write_gpio_trace(trace_writer, &repeated, 1) != SUCCESS)
+        {
+            close_gpio_trace_writer(trace_writer);
+            return false;
+        }
+    }
+
+    return close_gpio_trace_writer(trace_writer) == SUCCESS;
+}
+
+/*
+ * Name: check_short_files
+ * Description: Checks a trace without samples and a trace cut off inside its header block.
+ * Parameters:
+ *       file_name[in] - Path of a scratch file.
+ * Returns: None
+ */
+static void check_short_files(const char* file_name)
+{
+    TraceWriter* trace_writer;
+    TraceReader* trace_reader;
+    CaptureSample sample;
+    PinMask pin_mask;
+
+    check(open_gpio_trace_writer(file_name, TRACED_PINS, &trace_writer) == SUCCESS &&
+            close_gpio_trace_writer(trace_writer) == SUCCESS, "an empty trace can be written");
+
+    if(open_gpio_trace_reader(file_name, &pin_mask, &trace_reader) == SUCCESS)
+    {
+        seek_gpio_trace(trace_reader, FIRST_TIMESTAMP);
+        check(read_gpio_trace(trace_reader, &sample, 1) == 0, "an empty trace has no samples");
+        close_gpio_trace_reader(trace_reader);
+    }
+    else
+    {
+        check(false, "an empty trace can be opened");
+    }
+
+    check(truncate(file_name, TRACE_BLOCK_SIZE / 2) == 0 &&
+            open_gpio_trace_reader(file_name, &pin_mask, &trace_reader) == UNSUPPORTED,
+            "a trace shorter than its header block is UNSUPPORTED");
+}
+
+int main()
+{
+    char file_name[] = "/tmp/gpio_trace_XXXXXX";
+    TraceReader* trace_reader;
+    CaptureSample sample;
+    PinMask pin_mask;
+    int file;
+    int i;
+
+    file = mkstemp(file_name);
+
+    if(file < 0)
+    {
+        fprintf(stderr, "Cannot create a scratch file\n");
+        return EXIT_FAILURE;
+    }
+
+    close(file);
+    make_samples();
+
+    check(write_trace(file_name), "the trace can be written");
+
+    if(open_gpio_trace_reader(file_name, &pin_mask, &trace_reader) != SUCCESS)
+    {
+        fprintf(stderr, "Cannot open the trace\n");
+        unlink(file_name);
+        return EXIT_FAILURE;
+    }
+
+    check(pin_mask == TRACED_PINS, "the traced pins are kept");
+
+    // Every sample comes back in order, without the repeated ones
+    for(i = 0; i < SAMPLE_COUNT; i++)
+    {
+        check_next(trace_reader, &samples[i], "round trip");
+    }
+
+    check(read_gpio_trace(trace_reader, &sample, 1) == 0, "the trace ends after the last sample");
+
+    // Seeking to a sample, or to a time between two samples, gives the sample that holds the levels at that time
+    for(i = 0; i < SAMPLE_COUNT; i += SEEK_STRIDE)
+    {
+        seek_gpio_trace(trace_reader, samples[i].timestamp);
+        check_next(trace_reader, &samples[i], "seek to a sample");
+
+        seek_gpio_trace(trace_reader, samples[i].timestamp + 1);
+        check_next(trace_reader, &samples[i], "seek between samples");
+        check_next(trace_reader, &samples[i + 1], "read on after a seek");
+    }
+
+    seek_gpio_trace(trace_reader, 0);
+    check_next(trace_reader, &samples[0], "seek before the first sample");
+
+    seek_gpio_trace(trace_reader, UINT64_MAX);
+    check_next(trace_reader, &samples[SAMPLE_COUNT - 1], "seek after the last sample");
+
+    close_gpio_trace_reader(trace_reader);
+
+    check_short_files(file_name);
+    unlink(file_name);
+
+    return finish_checks("Trace");
+}
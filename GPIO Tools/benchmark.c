@@ -0,0 +1,305 @@
+/*
+ * File:        benchmark.c
+ * Description: Microbenchmark of the GPIO library hot paths (toggle rate, read latency, and bulk operations).
+ * Programmer:  tnewman
+ * Date:        Oct 16, 2026
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 Thomas Newman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "gpio.h"
+#include "register.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * Configuration
+ */
+#define DEFAULT_ITERATIONS 1000000
+#define DEFAULT_PIN 17
+#define LATENCY_SAMPLES 100000
+#define NANOSECONDS_PER_SECOND 1000000000ULL
+#define BUS_WIDTH 8
+
+/*
+ * Name: Benchmark
+ * Description: Associates a benchmark name with the operation that it measures.
+ */
+typedef struct {
+    const char* name;
+    void (*operation)();
+} Benchmark;
+
+/*
+ * Global Variables
+ */
+int benchmark_pin = DEFAULT_PIN; // Broadcom pin toggled and read by the benchmarks
+PinMask bus_mask = 0x00; // Pins driven by the bulk benchmarks
+PinMask bus_value = 0x00; // Value most recently written to the bus
+PinHandle benchmark_handle; // Handle of the benchmark pin
+volatile int sink = 0x00; // Keeps reads from being optimized away
+
+/*
+ * Benchmark Operations
+ */
+static void set_pin() { set_gpio_pin(benchmark_pin, BROADCOM); }
+static void clear_pin() { clear_gpio_pin(benchmark_pin, BROADCOM); }
+static void get_pin() { int value; get_gpio_pin(benchmark_pin, BROADCOM, &value); sink = value; }
+static void set_handle() { set_gpio_handle(&benchmark_handle); }
+static void clear_handle() { clear_gpio_handle(&benchmark_handle); }
+static void get_handle() { sink = get_gpio_handle(&benchmark_handle); }
+static void write_bus() { bus_value = ~bus_value; write_gpio_mask(bus_mask, bus_value, BROADCOM); }
+static void get_levels() { PinMask levels; get_gpio_levels(~(PinMask) 0x00 >> 10, BROADCOM, &levels); sink = (int) levels; }
+
+const Benchmark BENCHMARKS[] = {{"set_gpio_pin", set_pin}, {"clear_gpio_pin", clear_pin}, {"get_gpio_pin", get_pin},
+        {"set_gpio_handle", set_handle}, {"clear_gpio_handle", clear_handle}, {"get_gpio_handle", get_handle},
+        {"write_gpio_mask", write_bus}, {"get_gpio_levels", get_levels}};
+
+/*
+ * Name: get_nanoseconds
+ * Description: Reads the monotonic clock.
+ * Parameters: None
+ * Returns: The current time in nanoseconds.
+ */
+static unsigned long long get_nanoseconds()
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return time.tv_sec * NANOSECONDS_PER_SECOND + time.tv_nsec;
+}
+
+/*
+ * Name: compare_latencies
+ * Description: Orders latency samples for qsort.
+ * Parameters:
+ *       first[in] - The first latency sample.
+ *       second[in] - The second latency sample.
+ * Returns: Negative, zero, or positive as first is less than, equal to, or greater than second.
+ */
+static int compare_latencies(const void* first, const void* second)
+{
+    unsigned long long first_latency = *(const unsigned long long*) first;
+    unsigned long long second_latency = *(const unsigned long long*) second;
+
+    return (first_latency > second_latency) - (first_latency < second_latency);
+}
+
+/*
+ * Name: measure_clock_overhead
+ * Description: Measures the cost of the back-to-back clock reads that surround each latency sample.
+ * Parameters: None
+ * Returns: The smallest observed clock overhead in nanoseconds.
+ */
+static unsigned long long measure_clock_overhead()
+{
+    unsigned long long overhead = ~0ULL;
+    unsigned long long start;
+    unsigned long long elapsed;
+    int i;
+
+    for(i = 0; i < LATENCY_SAMPLES; i++)
+    {
+        start = get_nanoseconds();
+        elapsed = get_nanoseconds() - start;
+
+        if(elapsed < overhead)
+        {
+            overhead = elapsed;
+        }
+    }
+
+    return overhead;
+}
+
+/*
+ * Name: run_benchmark
+ * Description: Measures the throughput of an operation with one clock read around the whole run, then measures the 
+ *              latency of individual operations and prints both.
+ * Parameters:
+ *       benchmark[in] - The benchmark to run.
+ *       iterations[in] - Number of operations in the throughput run.
+ *       clock_overhead[in] - Clock overhead subtracted from each latency sample.
+ *       csv[in] - Non-zero to print a CSV row instead of a table row.
+ * Returns: None
+ */
+static void run_benchmark(const Benchmark* benchmark, long iterations, unsigned long long clock_overhead, int csv)
+{
+    static unsigned long long latencies[LATENCY_SAMPLES];
+    unsigned long long start;
+    unsigned long long elapsed;
+    double operations_per_second;
+    long i;
+
+    // Throughput
+    start = get_nanoseconds();
+
+    for(i = 0; i < iterations; i++)
+    {
+        benchmark->operation();
+    }
+
+    elapsed = get_nanoseconds() - start;
+    operations_per_second = (double) iterations * NANOSECONDS_PER_SECOND / (elapsed ? elapsed : 1);
+
+    // Latency
+    for(i = 0; i < LATENCY_SAMPLES; i++)
+    {
+        start = get_nanoseconds();
+        benchmark->operation();
+        elapsed = get_nanoseconds() - start;
+
+        latencies[i] = elapsed > clock_overhead ? elapsed - clock_overhead : 0;
+    }
+
+    qsort(latencies, LATENCY_SAMPLES, sizeof(latencies[0]), compare_latencies);
+
+    printf(csv ? "%s,%.0f,%llu,%llu,%llu,%llu\n" : "%-20s %14.0f %8llu %8llu %8llu %10llu\n", benchmark->name, 
+            operations_per_second, latencies[LATENCY_SAMPLES / 2], latencies[LATENCY_SAMPLES * 9 / 10], 
+            latencies[LATENCY_SAMPLES * 99 / 100], latencies[LATENCY_SAMPLES - 1]);
+}
+
+/*
+ * Name: print_usage
+ * Description: Prints the command line options.
+ * Parameters:
+ *       program[in] - Name of the program.
+ * Returns: None
+ */
+static void print_usage(const char* program)
+{
+    fprintf(stderr, "Usage: %s [-b memory|gpiomem|simulated] [-p broadcom_pin] [-n iterations] [-c]\n", program);
+    fprintf(stderr, "  -b  Register backend (default: simulated)\n");
+    fprintf(stderr, "  -p  Broadcom pin to toggle and read, 0 to %d (default: %d)\n", GPIO_PIN_COUNT - BUS_WIDTH, 
+            DEFAULT_PIN);
+    fprintf(stderr, "  -n  Operations per throughput run (default: %d)\n", DEFAULT_ITERATIONS);
+    fprintf(stderr, "  -c  Print CSV instead of a table\n");
+}
+
+int main(int argc, char* argv[])
+{
+    BackendType backend_type = SIMULATED_BACKEND;
+    long iterations = DEFAULT_ITERATIONS;
+    unsigned long long clock_overhead;
+    int csv = 0;
+    int option;
+    int i;
+    StatusCode status;
+
+    while((option = getopt(argc, argv, "b:p:n:c")) != -1)
+    {
+        switch(option)
+        {
+        case 'b':
+            if(strcmp(optarg, "memory") == 0)
+            {
+                backend_type = MEMORY_BACKEND;
+            }
+            else if(strcmp(optarg, "gpiomem") == 0)
+            {
+                backend_type = GPIOMEM_BACKEND;
+            }
+            else if(strcmp(optarg, "simulated") == 0)
+            {
+                backend_type = SIMULATED_BACKEND;
+            }
+            else
+            {
+                print_usage(argv[0]);
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'p':
+            benchmark_pin = atoi(optarg);
+
+            // The bus benchmarks shift a mask of BUS_WIDTH pins up to it
+            if(benchmark_pin < 0 || benchmark_pin > GPIO_PIN_COUNT - BUS_WIDTH)
+            {
+                print_usage(argv[0]);
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'n':
+            iterations = atol(optarg);
+            break;
+        case 'c':
+            csv = 1;
+            break;
+        default:
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    status = initialize_gpio_backend(backend_type);
+
+    if(status != SUCCESS)
+    {
+        fprintf(stderr, "initialize_gpio_backend failed with status %d\n", status);
+        return EXIT_FAILURE;
+    }
+
+    // The bus is the benchmark pin and the pins above it
+    bus_mask = (((PinMask) 1 << BUS_WIDTH) - 1) << benchmark_pin;
+
+    if(open_gpio_handle(benchmark_pin, BROADCOM, MODE_OUTPUT, &benchmark_handle) != SUCCESS || 
+       write_gpio_mask(bus_mask, bus_value, BROADCOM) != SUCCESS)
+    {
+        fprintf(stderr, "Broadcom pins %d to %d cannot be opened\n", benchmark_pin, benchmark_pin + BUS_WIDTH - 1);
+        finalize_gpio();
+        return EXIT_FAILURE;
+    }
+
+    clock_overhead = measure_clock_overhead();
+
+    if(csv)
+    {
+        printf("operation,ops_per_second,p50_ns,p90_ns,p99_ns,max_ns\n");
+    }
+    else
+    {
+        printf("%-20s %14s %8s %8s %8s %10s\n", "operation", "ops/s", "p50 ns", "p90 ns", "p99 ns", "max ns");
+    }
+
+    for(i = 0; i < (int) (sizeof(BENCHMARKS) / sizeof(Benchmark)); i++)
+    {
+        run_benchmark(&BENCHMARKS[i], iterations, clock_overhead, csv);
+    }
+
+    if(!csv)
+    {
+        printf("\nLatencies have %llu ns of clock overhead removed. write_gpio_mask drives %d pins per operation.\n", 
+                clock_overhead, BUS_WIDTH);
+    }
+
+    finalize_gpio();
+
+    return EXIT_SUCCESS;
+}
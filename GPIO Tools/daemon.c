@@ -0,0 +1,538 @@
+/*
+ * File:        daemon.c
+ * Description: GPIO daemon that owns the register mapping and serves unprivileged clients through shared memory
+ *              rings.
+ * Programmer:  tnewman
+ * Date:        Oct 16, 2026
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 Thomas Newman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#define _GNU_SOURCE
+
+#include "client.h"
+
+#include <errno.h>
+#include <grp.h>
+#include <poll.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/*
+ * Configuration
+ */
+#define DAEMON_MAX_CLIENTS 64
+#define DAEMON_SOCKET_MODE 0660 // Owner and group only; the group decides who may connect
+#define DAEMON_SOCKET_GROUP "gpio"
+#define DAEMON_SOCKET_BACKLOG 16
+#define DAEMON_IDLE_ROUNDS 10000 // Empty passes over the rings before the daemon sleeps
+#define DAEMON_ACCEPT_ROUNDS 4096 // Busy passes between checks for new and departed clients
+
+/*
+ * Name: Client
+ * Description: The daemon's side of a client connection.
+ */
+typedef struct {
+    int socket_file;
+    int wake_file;
+    DaemonRing* ring;
+} Client;
+
+/*
+ * Global Variables
+ */
+Client clients[DAEMON_MAX_CLIENTS]; // Connected clients, the first client_count are in use
+int client_count = 0; // Number of connected clients
+volatile sig_atomic_t running = 1; // Cleared by SIGINT and SIGTERM
+
+/*
+ * Name: stop_daemon
+ * Description: Signal handler that stops the main loop.
+ * Parameters:
+ *       signal_number[in] - The signal received.
+ * Returns: None
+ */
+static void stop_daemon(int signal_number)
+{
+    (void) signal_number;
+    running = 0;
+}
+
+/*
+ * Name: run_command
+ * Description: Runs one command and writes its results back in place.
+ * Parameters:
+ *       command[in,out] - The command.
+ * Returns: None
+ */
+static void run_command(DaemonCommand* command)
+{
+    PinType pin_type = (PinType) command->pin_type;
+    int value = 0; // Reported as 0 when the read fails
+
+    switch(command->operation)
+    {
+    case DAEMON_SET_PIN:
+        command->status = set_gpio_pin(command->pin_number, pin_type);
+        break;
+    case DAEMON_CLEAR_PIN:
+        command->status = clear_gpio_pin(command->pin_number, pin_type);
+        break;
+    case DAEMON_GET_PIN:
+        command->status = get_gpio_pin(command->pin_number, pin_type, &value);
+        command->pin_values = value;
+        break;
+    case DAEMON_SET_MODE:
+        command->status = set_gpio_pin_mode(command->pin_number, pin_type, (PinMode) command->pin_values);
+        break;
+    case DAEMON_WRITE_MASK:
+        command->status = write_gpio_mask(command->pin_mask, command->pin_values, pin_type);
+        break;
+    case DAEMON_GET_LEVELS:
+        command->status = get_gpio_levels(command->pin_mask, pin_type, &command->pin_values);
+        break;
+    default:
+        command->status = UNSUPPORTED;
+        break;
+    }
+}
+
+/*
+ * Name: run_rings
+ * Description: Runs every command waiting in the client rings.
+ * Parameters: None
+ * Returns: The number of commands run.
+ */
+static int run_rings()
+{
+    DaemonRing* ring;
+    unsigned int head;
+    unsigned int tail;
+    int commands_run = 0;
+    int i;
+
+    for(i = 0; i < client_count; i++)
+    {
+        ring = clients[i].ring;
+        tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+        head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+        if(head - tail > DAEMON_RING_SIZE)
+        {
+            // A client that overruns its own ring only loses its own commands
+            tail = head - DAEMON_RING_SIZE;
+        }
+
+        while(tail != head)
+        {
+            run_command(&ring->commands[tail % DAEMON_RING_SIZE]);
+            tail++;
+            commands_run++;
+        }
+
+        atomic_store_explicit(&ring->tail, tail, memory_order_release);
+    }
+
+    return commands_run;
+}
+
+/*
+ * Name: set_sleeping
+ * Description: Sets or clears the sleeping flag in every ring.
+ * Parameters:
+ *       sleeping[in] - The new value of the flag.
+ * Returns: None
+ */
+static void set_sleeping(unsigned int sleeping)
+{
+    int i;
+
+    for(i = 0; i < client_count; i++)
+    {
+        atomic_store_explicit(&clients[i].ring->daemon_sleeping, sleeping, memory_order_relaxed);
+    }
+
+    atomic_thread_fence(memory_order_seq_cst);
+}
+
+/*
+ * Name: add_client
+ * Description: Accepts a connection, creates its ring and eventfd, and sends them to the client.
+ * Parameters:
+ *       listen_file[in] - The listening socket.
+ * Returns: None
+ */
+static void add_client(int listen_file)
+{
+    Client* client = &clients[client_count];
+    char data = 0x00;
+    char control[CMSG_SPACE(2 * sizeof(int))];
+    struct iovec vector = {&data, sizeof(data)};
+    struct msghdr message;
+    struct cmsghdr* control_message;
+    int files[2];
+    int ring_file;
+
+    client->socket_file = accept4(listen_file, 0x00, 0x00, SOCK_CLOEXEC);
+
+    if(client->socket_file < 0)
+    {
+        return;
+    }
+
+    if(client_count == DAEMON_MAX_CLIENTS)
+    {
+        close(client->socket_file);
+        return;
+    }
+
+    ring_file = memfd_create("pio_ring", MFD_CLOEXEC);
+
+    if(ring_file < 0 || ftruncate(ring_file, sizeof(DaemonRing)) != 0)
+    {
+        goto close_ring;
+    }
+
+    client->ring = mmap(0x00, sizeof(DaemonRing), PROT_READ | PROT_WRITE, MAP_SHARED, ring_file, 0);
+
+    if(client->ring == MAP_FAILED)
+    {
+        goto close_ring;
+    }
+
+    client->wake_file = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if(client->wake_file < 0)
+    {
+        goto unmap_ring;
+    }
+
+    memset(&message, 0x00, sizeof(message));
+    message.msg_iov = &vector;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+
+    control_message = CMSG_FIRSTHDR(&message);
+    control_message->cmsg_level = SOL_SOCKET;
+    control_message->cmsg_type = SCM_RIGHTS;
+    control_message->cmsg_len = CMSG_LEN(2 * sizeof(int));
+    files[0] = ring_file;
+    files[1] = client->wake_file;
+    memcpy(CMSG_DATA(control_message), files, sizeof(files));
+
+    if(sendmsg(client->socket_file, &message, MSG_NOSIGNAL) != 1)
+    {
+        close(client->wake_file);
+        goto unmap_ring;
+    }
+
+    close(ring_file);
+    client_count++;
+
+    return;
+
+unmap_ring:
+    munmap(client->ring, sizeof(DaemonRing));
+close_ring:
+    if(ring_file >= 0)
+    {
+        close(ring_file);
+    }
+
+    close(client->socket_file);
+}
+
+/*
+ * Name: remove_client
+ * Description: Releases a client whose socket was closed.
+ * Parameters:
+ *       client_index[in] - Index of the client in clients.
+ * Returns: None
+ */
+static void remove_client(int client_index)
+{
+    Client* client = &clients[client_index];
+
+    munmap(client->ring, sizeof(DaemonRing));
+    close(client->wake_file);
+    close(client->socket_file);
+
+    clients[client_index] = clients[--client_count];
+}
+
+/*
+ * Name: poll_clients
+ * Description: Waits for a wake up, a new connection, or a departed client, and handles them.
+ * Parameters:
+ *       listen_file[in] - The listening socket.
+ *       timeout[in] - poll() timeout in milliseconds (-1 to wait indefinitely, 0 to only check).
+ * Returns: None
+ */
+static void poll_clients(int listen_file, int timeout)
+{
+    struct pollfd poll_files[1 + 2 * DAEMON_MAX_CLIENTS];
+    uint64_t wakes;
+    int poll_count = 1;
+    int i;
+
+    poll_files[0].fd = listen_file;
+    poll_files[0].events = POLLIN;
+
+    for(i = 0; i < client_count; i++)
+    {
+        poll_files[poll_count].fd = clients[i].socket_file;
+        poll_files[poll_count++].events = POLLIN;
+        poll_files[poll_count].fd = clients[i].wake_file;
+        poll_files[poll_count++].events = POLLIN;
+    }
+
+    if(poll(poll_files, poll_count, timeout) <= 0)
+    {
+        return;
+    }
+
+    // Walk backwards so removing a client does not move one that has not been checked
+    for(i = client_count - 1; i >= 0; i--)
+    {
+        if(poll_files[1 + 2 * i + 1].revents & POLLIN)
+        {
+            while(read(clients[i].wake_file, &wakes, sizeof(wakes)) > 0);
+        }
+
+        if(poll_files[1 + 2 * i].revents & (POLLIN | POLLHUP | POLLERR))
+        {
+            // Clients never send data, so a readable socket has been closed
+            remove_client(i);
+        }
+    }
+
+    if(poll_files[0].revents & POLLIN)
+    {
+        add_client(listen_file);
+    }
+}
+
+/*
+ * Name: open_socket
+ * Description: Creates the listening socket, replacing a stale socket file. The socket file belongs to the given 
+ *              group and gets DAEMON_SOCKET_MODE, so only root and members of the group can connect.
+ * Parameters:
+ *       socket_path[in] - Path of the socket.
+ *       group_id[in] - Group that may connect, or -1 to keep the daemon's group.
+ * Returns: The socket, or -1 on failure.
+ */
+static int open_socket(const char* socket_path, gid_t group_id)
+{
+    struct sockaddr_un address;
+    mode_t old_mask;
+    int listen_file;
+    int result;
+
+    memset(&address, 0x00, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, socket_path, sizeof(address.sun_path) - 1);
+
+    listen_file = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+    if(listen_file < 0)
+    {
+        return -1;
+    }
+
+    unlink(socket_path);
+
+    // Nobody else may connect in the window between bind() and chmod()
+    old_mask = umask(0177);
+    result = bind(listen_file, (struct sockaddr*) &address, sizeof(address));
+    umask(old_mask);
+
+    if(result != 0 || (group_id != (gid_t) -1 && chown(socket_path, (uid_t) -1, group_id) != 0) || 
+       chmod(socket_path, DAEMON_SOCKET_MODE) != 0 || listen(listen_file, DAEMON_SOCKET_BACKLOG) != 0)
+    {
+        close(listen_file);
+        return -1;
+    }
+
+    return listen_file;
+}
+
+/*
+ * Name: print_usage
+ * Description: Prints the command line options.
+ * Parameters:
+ *       program[in] - Name of the program.
+ * Returns: None
+ */
+static void print_usage(const char* program)
+{
+    fprintf(stderr, "Usage: %s [-b memory|gpiomem|simulated] [-s socket_path] [-g group]\n", program);
+    fprintf(stderr, "  -b  Register backend (default: memory)\n");
+    fprintf(stderr, "  -s  Socket path (default: %s)\n", DAEMON_SOCKET_PATH);
+    fprintf(stderr, "  -g  Group allowed to connect (default: %s)\n", DAEMON_SOCKET_GROUP);
+}
+
+int main(int argc, char* argv[])
+{
+    BackendType backend_type = MEMORY_BACKEND;
+    const char* socket_path = DAEMON_SOCKET_PATH;
+    const char* group_name = 0x00;
+    struct group* group;
+    gid_t group_id = (gid_t) -1;
+    struct sigaction action;
+    int listen_file;
+    int idle_rounds = 0;
+    int busy_rounds = 0;
+    int option;
+    StatusCode status;
+
+    while((option = getopt(argc, argv, "b:s:g:")) != -1)
+    {
+        switch(option)
+        {
+        case 'b':
+            if(strcmp(optarg, "memory") == 0)
+            {
+                backend_type = MEMORY_BACKEND;
+            }
+            else if(strcmp(optarg, "gpiomem") == 0)
+            {
+                backend_type = GPIOMEM_BACKEND;
+            }
+            else if(strcmp(optarg, "simulated") == 0)
+            {
+                backend_type = SIMULATED_BACKEND;
+            }
+            else
+            {
+                print_usage(argv[0]);
+                return EXIT_FAILURE;
+            }
+            break;
+        case 's':
+            socket_path = optarg;
+            break;
+        case 'g':
+            group_name = optarg;
+            break;
+        default:
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // A group named on the command line must exist; without the default group only root can connect
+    group = getgrnam(group_name ? group_name : DAEMON_SOCKET_GROUP);
+
+    if(group != 0x00)
+    {
+        group_id = group->gr_gid;
+    }
+    else if(group_name != 0x00)
+    {
+        fprintf(stderr, "Unknown group %s\n", group_name);
+        return EXIT_FAILURE;
+    }
+    else
+    {
+        fprintf(stderr, "No %s group, so only the daemon's own group can connect\n", DAEMON_SOCKET_GROUP);
+    }
+
+    status = initialize_gpio_backend(backend_type);
+
+    if(status != SUCCESS)
+    {
+        fprintf(stderr, "initialize_gpio_backend failed with status %d\n", status);
+        return EXIT_FAILURE;
+    }
+
+    listen_file = open_socket(socket_path, group_id);
+
+    if(listen_file < 0)
+    {
+        fprintf(stderr, "Cannot listen on %s: %s\n", socket_path, strerror(errno));
+        finalize_gpio();
+        return EXIT_FAILURE;
+    }
+
+    // No SA_RESTART, so a signal also ends a sleeping poll()
+    memset(&action, 0x00, sizeof(action));
+    action.sa_handler = stop_daemon;
+    sigaction(SIGINT, &action, 0x00);
+    sigaction(SIGTERM, &action, 0x00);
+
+    while(running)
+    {
+        if(run_rings() > 0)
+        {
+            idle_rounds = 0;
+
+            // Keep accepting clients while others keep the daemon busy
+            if(++busy_rounds >= DAEMON_ACCEPT_ROUNDS)
+            {
+                poll_clients(listen_file, 0);
+                busy_rounds = 0;
+            }
+        }
+        else if(++idle_rounds < DAEMON_IDLE_ROUNDS)
+        {
+            sched_yield();
+        }
+        else
+        {
+            // Announce the sleep, then look once more so a command pushed before the announcement is not missed
+            set_sleeping(1);
+
+            if(run_rings() == 0)
+            {
+                poll_clients(listen_file, -1);
+            }
+
+            set_sleeping(0);
+            idle_rounds = 0;
+        }
+    }
+
+    while(client_count > 0)
+    {
+        remove_client(client_count - 1);
+    }
+
+    close(listen_file);
+    unlink(socket_path);
+    finalize_gpio();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,312 @@
+/*
+ * File:        jitter.c
+ * Description: Measures loop jitter and worst-case register access latency, optionally on a prepared real-time
+ *              thread.
+ * Programmer:  tnewman
+ * Date:        Oct 16, 2026
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 Thomas Newman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "gpio.h"
+#include "realtime.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * Configuration
+ */
+#define DEFAULT_ITERATIONS 100000
+#define DEFAULT_INTERVAL 1000
+#define DEFAULT_PIN 17
+#define BUCKET_COUNT 32
+#define NANOSECONDS_PER_SECOND 1000000000ULL
+#define NANOSECONDS_PER_MICROSECOND 1000ULL
+
+/*
+ * Name: Histogram
+ * Description: A log2 latency histogram. Bucket n counts latencies below 2^n nanoseconds (the last bucket is open).
+ */
+typedef struct {
+    const char* name;
+    uint64_t buckets[BUCKET_COUNT];
+    uint64_t count;
+    uint64_t total;
+    uint64_t minimum;
+    uint64_t maximum;
+} Histogram;
+
+/*
+ * Name: get_nanoseconds
+ * Description: Reads the monotonic clock.
+ * Parameters: None
+ * Returns: The current time in nanoseconds.
+ */
+static uint64_t get_nanoseconds()
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return time.tv_sec * NANOSECONDS_PER_SECOND + time.tv_nsec;
+}
+
+/*
+ * Name: record_latency
+ * Description: Adds a latency to a histogram.
+ * Parameters:
+ *       histogram[in,out] - The histogram.
+ *       latency[in] - The latency in nanoseconds.
+ * Returns: None
+ */
+static void record_latency(Histogram* histogram, uint64_t latency)
+{
+    int bucket = latency == 0 ? 0 : 64 - __builtin_clzll(latency);
+
+    histogram->buckets[bucket < BUCKET_COUNT ? bucket : BUCKET_COUNT - 1]++;
+    histogram->count++;
+    histogram->total += latency;
+
+    if(latency < histogram->minimum)
+    {
+        histogram->minimum = latency;
+    }
+
+    if(latency > histogram->maximum)
+    {
+        histogram->maximum = latency;
+    }
+}
+
+/*
+ * Name: print_histogram
+ * Description: Prints the summary and the non-empty buckets of a histogram.
+ * Parameters:
+ *       histogram[in] - The histogram.
+ *       csv[in] - Non-zero to print CSV rows instead of a table.
+ * Returns: None
+ */
+static void print_histogram(const Histogram* histogram, int csv)
+{
+    int i;
+
+    if(csv)
+    {
+        printf("%s,summary,%llu,%llu,%llu,%llu\n", histogram->name, (unsigned long long) histogram->count, 
+                (unsigned long long) histogram->minimum, 
+                (unsigned long long) (histogram->count ? histogram->total / histogram->count : 0), 
+                (unsigned long long) histogram->maximum);
+    }
+    else
+    {
+        printf("%s: %llu samples, min %llu ns, avg %llu ns, max %llu ns\n", histogram->name, 
+                (unsigned long long) histogram->count, (unsigned long long) histogram->minimum, 
+                (unsigned long long) (histogram->count ? histogram->total / histogram->count : 0), 
+                (unsigned long long) histogram->maximum);
+    }
+
+    for(i = 0; i < BUCKET_COUNT; i++)
+    {
+        if(histogram->buckets[i] == 0)
+        {
+            continue;
+        }
+
+        printf(csv ? "%s,bucket,%llu,%llu\n" : "%s  < %10llu ns %12llu\n", csv ? histogram->name : "", 1ULL << i, 
+                (unsigned long long) histogram->buckets[i]);
+    }
+}
+
+/*
+ * Name: print_usage
+ * Description: Prints the command line options.
+ * Parameters:
+ *       program[in] - Name of the program.
+ * Returns: None
+ */
+static void print_usage(const char* program)
+{
+    fprintf(stderr, "Usage: %s [-b memory|gpiomem|simulated] [-p broadcom_pin] [-n iterations] [-i interval_us] "
+            "[-C cpu] [-r priority] [-c]\n", program);
+    fprintf(stderr, "  -b  Register backend (default: simulated)\n");
+    fprintf(stderr, "  -p  Broadcom pin to toggle and read (default: %d)\n", DEFAULT_PIN);
+    fprintf(stderr, "  -n  Loop iterations (default: %d)\n", DEFAULT_ITERATIONS);
+    fprintf(stderr, "  -i  Loop period in microseconds, 0 for a free-running loop (default: %d)\n", DEFAULT_INTERVAL);
+    fprintf(stderr, "  -C  CPU to pin the loop to (default: none)\n");
+    fprintf(stderr, "  -r  SCHED_FIFO priority, 0 to keep the normal scheduler (default: 0)\n");
+    fprintf(stderr, "  -c  Print CSV instead of a table\n");
+}
+
+int main(int argc, char* argv[])
+{
+    BackendType backend_type = SIMULATED_BACKEND;
+    Histogram wakeup = {"wakeup_latency", {0}, 0, 0, UINT64_MAX, 0};
+    Histogram access = {"access_latency", {0}, 0, 0, UINT64_MAX, 0};
+    PinHandle handle;
+    struct timespec deadline;
+    uint64_t interval = DEFAULT_INTERVAL * NANOSECONDS_PER_MICROSECOND;
+    uint64_t next;
+    uint64_t start;
+    uint64_t end;
+    long iterations = DEFAULT_ITERATIONS;
+    long i;
+    volatile int sink;
+    int pin = DEFAULT_PIN;
+    int cpu = -1;
+    int priority = 0;
+    int csv = 0;
+    int option;
+    StatusCode status;
+
+    while((option = getopt(argc, argv, "b:p:n:i:C:r:c")) != -1)
+    {
+        switch(option)
+        {
+        case 'b':
+            if(strcmp(optarg, "memory") == 0)
+            {
+                backend_type = MEMORY_BACKEND;
+            }
+            else if(strcmp(optarg, "gpiomem") == 0)
+            {
+                backend_type = GPIOMEM_BACKEND;
+            }
+            else if(strcmp(optarg, "simulated") == 0)
+            {
+                backend_type = SIMULATED_BACKEND;
+            }
+            else
+            {
+                print_usage(argv[0]);
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'p':
+            pin = atoi(optarg);
+            break;
+        case 'n':
+            iterations = atol(optarg);
+            break;
+        case 'i':
+            interval = strtoull(optarg, 0x00, 10) * NANOSECONDS_PER_MICROSECOND;
+            break;
+        case 'C':
+            cpu = atoi(optarg);
+            break;
+        case 'r':
+            priority = atoi(optarg);
+            break;
+        case 'c':
+            csv = 1;
+            break;
+        default:
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    status = initialize_gpio_backend(backend_type);
+
+    if(status != SUCCESS)
+    {
+        fprintf(stderr, "initialize_gpio_backend failed with status %d\n", status);
+        return EXIT_FAILURE;
+    }
+
+    if(open_gpio_handle(pin, BROADCOM, MODE_OUTPUT, &handle) != SUCCESS)
+    {
+        fprintf(stderr, "Broadcom pin %d cannot be opened\n", pin);
+        finalize_gpio();
+        return EXIT_FAILURE;
+    }
+
+    // Without the preparation the results show what an ordinary process gets
+    status = prepare_realtime_thread(cpu, priority, REALTIME_STACK_PREFAULT);
+
+    if(status != SUCCESS)
+    {
+        fprintf(stderr, "prepare_realtime_thread failed with status %d, measuring anyway\n", status);
+    }
+
+    next = get_nanoseconds() + interval;
+
+    for(i = 0; i < iterations; i++)
+    {
+        // Wake up on a fixed period (or run free) and measure how late the loop is
+        if(interval > 0)
+        {
+            deadline.tv_sec = next / NANOSECONDS_PER_SECOND;
+            deadline.tv_nsec = next % NANOSECONDS_PER_SECOND;
+
+            // An absolute deadline can simply be slept for again after a signal; other errors would repeat forever
+            while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, 0x00) == EINTR);
+        }
+
+        start = get_nanoseconds();
+
+        if(interval > 0)
+        {
+            record_latency(&wakeup, start > next ? start - next : 0);
+            next += interval;
+        }
+        else if(i > 0)
+        {
+            record_latency(&wakeup, start - next);
+        }
+
+        // One toggle and one read back, the smallest useful unit of GPIO work
+        set_gpio_handle(&handle);
+        clear_gpio_handle(&handle);
+        sink = get_gpio_handle(&handle);
+        end = get_nanoseconds();
+
+        record_latency(&access, end - start);
+
+        if(interval == 0)
+        {
+            next = end;
+        }
+    }
+
+    (void) sink;
+
+    if(interval == 0)
+    {
+        wakeup.name = "loop_gap";
+    }
+
+    print_histogram(&wakeup, csv);
+    print_histogram(&access, csv);
+
+    finalize_gpio();
+
+    return EXIT_SUCCESS;
+}
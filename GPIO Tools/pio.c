@@ -0,0 +1,652 @@
+/*
+ * File:        pio.c
+ * Description: Command line tool that sets, clears, and reads GPIO pins from arguments, a script, or standard input.
+ * Programmer:  tnewman
+ * Date:        Oct 16, 2026
+ */
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013 Thomas Newman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "gpio.h"
+#include "simulator.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * Configuration
+ */
+#define MAX_SCRIPT_LINE_LENGTH 1024
+#define MAX_LOOP_DEPTH 16
+#define INITIAL_PROGRAM_SIZE 64
+#define NANOSECONDS_PER_SECOND 1000000000ULL
+#define NANOSECONDS_PER_MICROSECOND 1000ULL
+
+/*
+ * Name: Opcode
+ * Description: Specifies what an instruction does.
+ */
+typedef enum {
+    OP_SET, // set <pin>
+    OP_CLEAR, // clear <pin>
+    OP_READ, // read <pin>
+    OP_MODE, // mode <pin> in|out|alt0-alt5
+    OP_WRITE, // write <mask> <values>
+    OP_LEVELS, // levels <mask>
+    OP_DELAY, // delay <microseconds>
+    OP_LOOP, // loop <count>
+    OP_END // end
+} Opcode;
+
+/*
+ * Name: Instruction
+ * Description: One parsed command. Scripts are parsed completely before anything runs, so loops run without parsing.
+ */
+typedef struct {
+    Opcode opcode;
+    int line; // Script line, for error and timing output
+    int pin_number;
+    PinMode pin_mode;
+    PinMask pin_mask;
+    PinMask pin_values;
+    uint64_t count; // Delay in microseconds or loop count
+    int jump; // Index of the matching end (loop) or loop (end)
+} Instruction;
+
+/*
+ * Name: Program
+ * Description: A growable list of instructions and the state of the parser.
+ */
+typedef struct {
+    Instruction* instructions;
+    int instruction_count;
+    int instruction_capacity;
+    int open_loops[MAX_LOOP_DEPTH];
+    int loop_depth;
+} Program;
+
+/*
+ * Global Variables
+ */
+const char* OPCODE_NAMES[] = {"set", "clear", "read", "mode", "write", "levels", "delay", "loop", "end"};
+const char* MODE_NAMES[] = {"in", "out", "alt5", "alt4", "alt0", "alt1", "alt2", "alt3"}; // Indexed by PinMode
+PinType pin_type = BROADCOM; // Numbering of the pins in the script
+BackendType backend_type = MEMORY_BACKEND; // Register backend
+int timing = 0; // Non-zero to print a timing record for every instruction
+
+/*
+ * Name: get_nanoseconds
+ * Description: Reads the monotonic clock.
+ * Parameters: None
+ * Returns: The current time in nanoseconds.
+ */
+static unsigned long long get_nanoseconds()
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return time.tv_sec * NANOSECONDS_PER_SECOND + time.tv_nsec;
+}
+
+/*
+ * Name: parse_number
+ * Description: Parses a decimal, hexadecimal (0x), or octal (0) number.
+ * Parameters:
+ *       text[in] - The text to parse.
+ *       number[out] - The number.
+ * Returns: 1 if the whole text is a number, otherwise 0.
+ */
+static int parse_number(const char* text, uint64_t* number)
+{
+    char* end;
+
+    if(text == 0x00 || !isdigit((unsigned char) text[0]))
+    {
+        return 0;
+    }
+
+    *number = strtoull(text, &end, 0);
+
+    return *end == '\0';
+}
+
+/*
+ * Name: parse_command
+ * Description: Parses one command and appends it to a program.
+ * Parameters:
+ *       program[in,out] - The program.
+ *       words[in] - The command name and its arguments.
+ *       word_count[in] - Number of words.
+ *       line[in] - Script line of the command.
+ * Returns: 1 on success, otherwise 0 (the error has been printed).
+ */
+static int parse_command(Program* program, char** words, int word_count, int line)
+{
+    Instruction instruction;
+    uint64_t number;
+    int argument_count;
+    int opcode;
+
+    memset(&instruction, 0x00, sizeof(instruction));
+    instruction.line = line;
+
+    for(opcode = 0; opcode < (int) (sizeof(OPCODE_NAMES) / sizeof(OPCODE_NAMES[0])); opcode++)
+    {
+        if(strcmp(words[0], OPCODE_NAMES[opcode]) == 0)
+        {
+            break;
+        }
+    }
+
+    instruction.opcode = (Opcode) opcode;
+    argument_count = word_count - 1;
+
+    switch(opcode)
+    {
+    case OP_SET:
+    case OP_CLEAR:
+    case OP_READ:
+    case OP_MODE:
+        if(argument_count != (opcode == OP_MODE ? 2 : 1) || !parse_number(words[1], &number))
+        {
+            fprintf(stderr, "line %d: usage: %s <pin>%s\n", line, words[0], opcode == OP_MODE ? " <mode>" : "");
+            return 0;
+        }
+
+        instruction.pin_number = (int) number;
+
+        if(opcode == OP_MODE)
+        {
+            for(number = 0; number < sizeof(MODE_NAMES) / sizeof(MODE_NAMES[0]); number++)
+            {
+                if(strcmp(words[2], MODE_NAMES[number]) == 0)
+                {
+                    break;
+                }
+            }
+
+            if(number == sizeof(MODE_NAMES) / sizeof(MODE_NAMES[0]))
+            {
+                fprintf(stderr, "line %d: unknown mode %s (in, out, or alt0 to alt5)\n", line, words[2]);
+                return 0;
+            }
+
+            instruction.pin_mode = (PinMode) number;
+        }
+        break;
+    case OP_WRITE:
+        if(argument_count != 2 || !parse_number(words[1], &instruction.pin_mask) || 
+           !parse_number(words[2], &instruction.pin_values))
+        {
+            fprintf(stderr, "line %d: usage: write <mask> <values>\n", line);
+            return 0;
+        }
+        break;
+    case OP_LEVELS:
+        if(argument_count != 1 || !parse_number(words[1], &instruction.pin_mask))
+        {
+            fprintf(stderr, "line %d: usage: levels <mask>\n", line);
+            return 0;
+        }
+        break;
+    case OP_DELAY:
+    case OP_LOOP:
+        if(argument_count != 1 || !parse_number(words[1], &instruction.count))
+        {
+            fprintf(stderr, "line %d: usage: %s\n", line, opcode == OP_DELAY ? "delay <microseconds>" : "loop <count>");
+            return 0;
+        }
+
+        if(opcode == OP_LOOP)
+        {
+            if(program->loop_depth == MAX_LOOP_DEPTH)
+            {
+                fprintf(stderr, "line %d: loops are nested more than %d deep\n", line, MAX_LOOP_DEPTH);
+                return 0;
+            }
+
+            program->open_loops[program->loop_depth++] = program->instruction_count;
+        }
+        break;
+    case OP_END:
+        if(argument_count != 0)
+        {
+            fprintf(stderr, "line %d: usage: end\n", line);
+            return 0;
+        }
+
+        if(program->loop_depth == 0)
+        {
+            fprintf(stderr, "line %d: end without loop\n", line);
+            return 0;
+        }
+
+        instruction.jump = program->open_loops[--program->loop_depth];
+        program->instructions[instruction.jump].jump = program->instruction_count;
+        break;
+    default:
+        fprintf(stderr, "line %d: unknown command %s\n", line, words[0]);
+        return 0;
+    }
+
+    if(program->instruction_count == program->instruction_capacity)
+    {
+        program->instruction_capacity = program->instruction_capacity ? program->instruction_capacity * 2 : 
+                INITIAL_PROGRAM_SIZE;
+        program->instructions = realloc(program->instructions, program->instruction_capacity * sizeof(Instruction));
+
+        if(program->instructions == 0x00)
+        {
+            fprintf(stderr, "out of memory\n");
+            return 0;
+        }
+    }
+
+    program->instructions[program->instruction_count++] = instruction;
+
+    return 1;
+}
+
+/*
+ * Name: parse_line
+ * Description: Parses a script line. Commands are separated by ; and everything after # is a comment.
+ * Parameters:
+ *       program[in,out] - The program.
+ *       text[in] - The line (modified while parsing).
+ *       line[in] - Script line number.
+ * Returns: 1 on success, otherwise 0.
+ */
+static int parse_line(Program* program, char* text, int line)
+{
+    char* words[MAX_SCRIPT_LINE_LENGTH / 2 + 1]; // Every other character can start a word, plus the terminator
+    char* command;
+    char* next_command;
+    char* comment;
+    int word_count;
+
+    comment = strchr(text, '#');
+
+    if(comment != 0x00)
+    {
+        *comment = '\0';
+    }
+
+    for(command = text; command != 0x00; command = next_command)
+    {
+        next_command = strchr(command, ';');
+
+        if(next_command != 0x00)
+        {
+            *next_command++ = '\0';
+        }
+
+        word_count = 0;
+
+        for(words[0] = strtok(command, " \t\r\n"); words[word_count] != 0x00; 
+            words[word_count] = strtok(0x00, " \t\r\n"))
+        {
+            word_count++;
+        }
+
+        if(word_count > 0 && !parse_command(program, words, word_count, line))
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/*
+ * Name: parse_file
+ * Description: Parses every line of a script.
+ * Parameters:
+ *       program[in,out] - The program.
+ *       file[in] - The script.
+ * Returns: 1 on success, otherwise 0.
+ */
+static int parse_file(Program* program, FILE* file)
+{
+    char text[MAX_SCRIPT_LINE_LENGTH];
+    int line = 0;
+
+    while(fgets(text, sizeof(text), file) != 0x00)
+    {
+        if(!parse_line(program, text, ++line))
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/*
+ * Name: delay
+ * Description: Sleeps for a number of microseconds.
+ * Parameters:
+ *       microseconds[in] - The delay.
+ * Returns: None
+ */
+static void delay(uint64_t microseconds)
+{
+    struct timespec time;
+    uint64_t nanoseconds = microseconds * NANOSECONDS_PER_MICROSECOND;
+
+    time.tv_sec = nanoseconds / NANOSECONDS_PER_SECOND;
+    time.tv_nsec = nanoseconds % NANOSECONDS_PER_SECOND;
+
+    // Only a signal is worth sleeping the rest of the time for; any other error would fail again
+    while(clock_nanosleep(CLOCK_MONOTONIC, 0, &time, &time) == EINTR);
+}
+
+/*
+ * Name: apply_simulated_stores
+ * Description: Applies the last set and clear stores to the simulated output latch. The simulation only keeps the 
+ *              last store to each register between updates, so a store that is not applied at once can be lost.
+ * Parameters: None
+ * Returns: None
+ */
+static void apply_simulated_stores()
+{
+    if(backend_type == SIMULATED_BACKEND)
+    {
+        update_simulated_gpio();
+    }
+}
+
+/*
+ * Name: run_program
+ * Description: Runs a parsed program. Reads print their result; with timing on, every instruction prints a 
+ *              tab-separated record of line, command, result, and elapsed nanoseconds.
+ * Parameters:
+ *       program[in] - The program.
+ * Returns: SUCCESS, or the status of the first instruction that failed.
+ */
+static StatusCode run_program(const Program* program)
+{
+    uint64_t loop_counts[MAX_LOOP_DEPTH];
+    unsigned long long start = 0;
+    unsigned long long end;
+    const Instruction* instruction;
+    PinMask result = 0x00;
+    StatusCode status;
+    int loop_depth = 0;
+    int value;
+    int i;
+
+    for(i = 0; i < program->instruction_count; i++)
+    {
+        instruction = &program->instructions[i];
+        status = SUCCESS;
+
+        if(timing)
+        {
+            start = get_nanoseconds();
+        }
+
+        switch(instruction->opcode)
+        {
+        case OP_SET:
+            status = set_gpio_pin(instruction->pin_number, pin_type);
+            apply_simulated_stores();
+            break;
+        case OP_CLEAR:
+            status = clear_gpio_pin(instruction->pin_number, pin_type);
+            apply_simulated_stores();
+            break;
+        case OP_READ:
+            if(backend_type == SIMULATED_BACKEND)
+            {
+                update_simulated_gpio();
+            }
+
+            status = get_gpio_pin(instruction->pin_number, pin_type, &value);
+            result = value;
+            break;
+        case OP_MODE:
+            status = set_gpio_pin_mode(instruction->pin_number, pin_type, instruction->pin_mode);
+            break;
+        case OP_WRITE:
+            status = write_gpio_mask(instruction->pin_mask, instruction->pin_values, pin_type);
+            apply_simulated_stores();
+            break;
+        case OP_LEVELS:
+            if(backend_type == SIMULATED_BACKEND)
+            {
+                update_simulated_gpio();
+            }
+
+            status = get_gpio_levels(instruction->pin_mask, pin_type, &result);
+            break;
+        case OP_DELAY:
+            delay(instruction->count);
+            break;
+        case OP_LOOP:
+            if(instruction->count == 0)
+            {
+                i = instruction->jump;
+                continue;
+            }
+
+            loop_counts[loop_depth++] = instruction->count;
+            continue;
+        case OP_END:
+            if(--loop_counts[loop_depth - 1] > 0)
+            {
+                i = instruction->jump;
+            }
+            else
+            {
+                loop_depth--;
+            }
+            continue;
+        }
+
+        if(status != SUCCESS)
+        {
+            fprintf(stderr, "line %d: %s failed with status %d\n", instruction->line, 
+                    OPCODE_NAMES[instruction->opcode], status);
+            return status;
+        }
+
+        if(timing)
+        {
+            end = get_nanoseconds();
+
+            if(instruction->opcode == OP_READ || instruction->opcode == OP_LEVELS)
+            {
+                printf("%d\t%s\t0x%llx\t%llu\n", instruction->line, OPCODE_NAMES[instruction->opcode], 
+                        (unsigned long long) result, end - start);
+            }
+            else
+            {
+                printf("%d\t%s\t-\t%llu\n", instruction->line, OPCODE_NAMES[instruction->opcode], end - start);
+            }
+        }
+        else if(instruction->opcode == OP_READ)
+        {
+            printf("%d\n", (int) result);
+        }
+        else if(instruction->opcode == OP_LEVELS)
+        {
+            printf("0x%llx\n", (unsigned long long) result);
+        }
+    }
+
+    return SUCCESS;
+}
+
+/*
+ * Name: print_usage
+ * Description: Prints the command line options and the script commands.
+ * Parameters:
+ *       program[in] - Name of the program.
+ * Returns: None
+ */
+static void print_usage(const char* program)
+{
+    fprintf(stderr, "Usage: %s [-b memory|gpiomem|simulated] [-p] [-t] [-f script | command ...]\n", program);
+    fprintf(stderr, "  -b  Register backend (default: memory)\n");
+    fprintf(stderr, "  -p  Pin numbers are P1 connector positions instead of Broadcom numbers\n");
+    fprintf(stderr, "  -t  Print line, command, result, and nanoseconds for every command\n");
+    fprintf(stderr, "  -f  Run a script file (- for standard input, the default without commands)\n");
+    fprintf(stderr, "Commands (separate with ; or newlines, # starts a comment):\n");
+    fprintf(stderr, "  set <pin>, clear <pin>, read <pin>, mode <pin> in|out|alt0-alt5,\n");
+    fprintf(stderr, "  write <mask> <values>, levels <mask>, delay <microseconds>, loop <count> ... end\n");
+}
+
+int main(int argc, char* argv[])
+{
+    Program program;
+    char text[MAX_SCRIPT_LINE_LENGTH];
+    const char* script_path = 0x00;
+    unsigned long long start;
+    FILE* script_file;
+    size_t length = 0;
+    int option;
+    int parsed;
+    int i;
+    StatusCode status;
+
+    memset(&program, 0x00, sizeof(program));
+
+    while((option = getopt(argc, argv, "+b:ptf:")) != -1)
+    {
+        switch(option)
+        {
+        case 'b':
+            if(strcmp(optarg, "memory") == 0)
+            {
+                backend_type = MEMORY_BACKEND;
+            }
+            else if(strcmp(optarg, "gpiomem") == 0)
+            {
+                backend_type = GPIOMEM_BACKEND;
+            }
+            else if(strcmp(optarg, "simulated") == 0)
+            {
+                backend_type = SIMULATED_BACKEND;
+            }
+            else
+            {
+                print_usage(argv[0]);
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'p':
+            pin_type = P1CONNECTOR;
+            break;
+        case 't':
+            timing = 1;
+            break;
+        case 'f':
+            script_path = optarg;
+            break;
+        default:
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Parse everything before mapping the registers, so a bad script changes nothing
+    if(optind < argc)
+    {
+        text[0] = '\0';
+
+        for(i = optind; i < argc; i++)
+        {
+            length += strlen(argv[i]) + 1;
+
+            if(length >= sizeof(text))
+            {
+                fprintf(stderr, "command line is too long, use a script\n");
+                return EXIT_FAILURE;
+            }
+
+            strcat(text, argv[i]);
+            strcat(text, " ");
+        }
+
+        parsed = parse_line(&program, text, 1);
+    }
+    else if(script_path == 0x00 || strcmp(script_path, "-") == 0)
+    {
+        parsed = parse_file(&program, stdin);
+    }
+    else
+    {
+        script_file = fopen(script_path, "r");
+
+        if(script_file == 0x00)
+        {
+            fprintf(stderr, "cannot open %s\n", script_path);
+            return EXIT_FAILURE;
+        }
+
+        parsed = parse_file(&program, script_file);
+        fclose(script_file);
+    }
+
+    if(parsed && program.loop_depth > 0)
+    {
+        fprintf(stderr, "line %d: loop without end\n", program.instructions[program.open_loops[0]].line);
+        parsed = 0;
+    }
+
+    if(!parsed)
+    {
+        free(program.instructions);
+        return EXIT_FAILURE;
+    }
+
+    status = initialize_gpio_backend(backend_type);
+
+    if(status != SUCCESS)
+    {
+        fprintf(stderr, "initialize_gpio_backend failed with status %d\n", status);
+        free(program.instructions);
+        return EXIT_FAILURE;
+    }
+
+    start = get_nanoseconds();
+    status = run_program(&program);
+
+    if(timing)
+    {
+        printf("total\t-\t-\t%llu\n", get_nanoseconds() - start);
+    }
+
+    finalize_gpio();
+    free(program.instructions);
+
+    return status == SUCCESS ? EXIT_SUCCESS : EXIT_FAILURE;
+}